@@ -3,9 +3,13 @@
 #include "SimpleGossip.h"
 #include "ScriptedGossip.h"
 #include "Creature.h"
+#include "ObjectAccessor.h"
 #include "Player.h"
+#include "WorldPacket.h"
+#include "WorldSession.h"
+#include <algorithm>
 #include <iostream>
-#include <unordered_map>
+#include <typeinfo>
 #include <vector>
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -16,7 +20,7 @@ bool SimpleGossipOption::ShowOption(Player* player) { return true; }
 
 SimpleGossipOptionIconText::SimpleGossipOptionIconText(
     GossipOptionIcon icon,
-    std::string text,
+    SimpleGossipText text,
     SGIconTextCallback callback)
 {
     Icon = icon;
@@ -26,8 +30,8 @@ SimpleGossipOptionIconText::SimpleGossipOptionIconText(
 
 SimpleGossipOptionIconTextPopup::SimpleGossipOptionIconTextPopup(
     GossipOptionIcon icon,
-    std::string text,
-    std::string popupText,
+    SimpleGossipText text,
+    SimpleGossipText popupText,
     uint32 popupCopper,
     SGIconTextPopupCallback callback)
 {
@@ -40,8 +44,8 @@ SimpleGossipOptionIconTextPopup::SimpleGossipOptionIconTextPopup(
 
 SimpleGossipOptionIconTextPopup::SimpleGossipOptionIconTextPopup(
     GossipOptionIcon icon,
-    std::string text,
-    std::string popupText,
+    SimpleGossipText text,
+    SimpleGossipText popupText,
     uint32 popupGold,
     uint8 popupSilver,
     uint8 popupCopper,
@@ -69,19 +73,24 @@ bool SimpleGossipOption::SelectOption(Player* player)
     if (CloseDialogOnSelect)
     {
         ClearGossipMenuFor(player);
-        CloseGossipMenuFor(player);
+        Gossip->CloseGossip(player);
     }
 
-    // Next parts > restarting
-    if (NextParts.size() > 0)
+    // Going back > next parts > restarting
+    if (GoBack)
     {
-        if (NextTextId != 0)
+        Gossip->ShowPreviousPage(player);
+    }
+    else if (NextParts.size() > 0)
+    {
+        uint32 textId = NextTextId != 0 ? NextTextId : Gossip->StartingTextId;
+        if (Gossip->IsFinalized() && NextPage != SIMPLEGOSSIP_NO_PAGE)
         {
-            Gossip->ShowParts(player, NextTextId, NextParts);
+            Gossip->ShowPage(player, textId, NextPage);
         }
         else
         {
-            Gossip->ShowParts(player, NextParts);
+            Gossip->ShowParts(player, textId, NextParts);
         }
     }
     else if (NextTextId != 0)
@@ -115,11 +124,13 @@ bool SimpleGossipOptionIconText::SelectOption(Player* player)
 }
 bool SimpleGossipOptionIconText::ShowOption(Player* player)
 {
-    if (ConditionallyShow != nullptr && !ConditionallyShow(player, this))
+    if (ConditionallyShow != nullptr && !SIMPLEGOSSIP_PROFILE_CONDITION(this, ConditionallyShow(player, this)))
     {
         return false;
     }
-    AddGossipItemFor(player, Icon, Text, GOSSIP_SENDER_MAIN, OptionId);
+    SIMPLEGOSSIP_PROFILE_COUNT(this, Renders);
+    AddGossipItemFor(player, Icon, Text.Get(SimpleGossipStrings::GetLocale(player)), GOSSIP_SENDER_MAIN, OptionId);
+    Gossip->MarkShown(player, OptionId);
     return true;
 }
 
@@ -144,11 +155,14 @@ bool SimpleGossipOptionIconTextPopup::SelectOption(Player* player)
 }
 bool SimpleGossipOptionIconTextPopup::ShowOption(Player* player)
 {
-    if (ConditionallyShow != nullptr && !ConditionallyShow(player, this))
+    if (ConditionallyShow != nullptr && !SIMPLEGOSSIP_PROFILE_CONDITION(this, ConditionallyShow(player, this)))
     {
         return false;
     }
-    AddGossipItemFor(player, Icon, Text, GOSSIP_SENDER_MAIN, OptionId, PopupText, PopupCopper, IsCoded);
+    SIMPLEGOSSIP_PROFILE_COUNT(this, Renders);
+    LocaleConstant locale = SimpleGossipStrings::GetLocale(player);
+    AddGossipItemFor(player, Icon, Text.Get(locale), GOSSIP_SENDER_MAIN, OptionId, PopupText.Get(locale), PopupCopper, IsCoded);
+    Gossip->MarkShown(player, OptionId);
     return true;
 }
 
@@ -166,11 +180,163 @@ bool SimpleGossipOptionDatabaseMenu::SelectOption(Player* player)
 }
 bool SimpleGossipOptionDatabaseMenu::ShowOption(Player* player)
 {
-    if (ConditionallyShow != nullptr && !ConditionallyShow(player, this))
+    if (ConditionallyShow != nullptr && !SIMPLEGOSSIP_PROFILE_CONDITION(this, ConditionallyShow(player, this)))
     {
         return false;
     }
+    SIMPLEGOSSIP_PROFILE_COUNT(this, Renders);
     AddGossipItemFor(player, MenuId, MenuItemId, GOSSIP_SENDER_MAIN, OptionId);
+    Gossip->MarkShown(player, OptionId);
+    return true;
+}
+
+SimpleGossipOptionGenerator::SimpleGossipOptionGenerator(
+    SGGenerator generator,
+    SGGeneratorCallback callback)
+{
+    Generator = generator;
+    GeneratorCallback = callback;
+}
+
+bool SimpleGossipOptionGenerator::ShowOption(Player* player)
+{
+    if (ConditionallyShow != nullptr && !SIMPLEGOSSIP_PROFILE_CONDITION(this, ConditionallyShow(player, this)))
+    {
+        return false;
+    }
+    SIMPLEGOSSIP_PROFILE_COUNT(this, Renders);
+    AddItems(player, 0, false);
+    return true;
+}
+
+// The generator itself is never sent as an item, only what it generates
+bool SimpleGossipOptionGenerator::SelectOption(Player* player)
+{
+    return false;
+}
+
+bool SimpleGossipOptionGenerator::ShowPage(Player* player, uint32 page)
+{
+    ObjectGuid sender = Gossip->GetSender(player);
+    ClearGossipMenuFor(player);
+    Gossip->BeginRender(player, sender);
+    AddItems(player, page, true);
+    SendGossipMenuFor(player, PageTextId != 0 ? PageTextId : Gossip->StartingTextId, sender);
+    return true;
+}
+
+void SimpleGossipOptionGenerator::AddItems(Player* player, uint32 page, bool standalone)
+{
+    if (!Generator)
+    {
+        return;
+    }
+    // Every item carries the generator as sender, so one bit and the page sent cover the whole list
+    SimpleGossipSession::GeneratorPage shown = { OptionId, page, 0, page > 0, false, standalone };
+
+    uint32 pageSize = std::min(std::max(PageSize, 1u), MAX_PAGE_SIZE);
+    uint32 first = page * pageSize;
+    for (uint32 i = 0; i < pageSize; ++i)
+    {
+        if (!Generator(player, first + i, Scratch))
+        {
+            break;
+        }
+        ++shown.ItemCount;
+
+        uint32 action = (page << 16) | i;
+        if (Scratch.PopupText.empty())
+        {
+            AddGossipItemFor(player, Scratch.Icon, Scratch.Text, OptionId, action);
+        }
+        else
+        {
+            AddGossipItemFor(player, Scratch.Icon, Scratch.Text, OptionId, action, Scratch.PopupText, 0, Scratch.IsCoded);
+        }
+    }
+
+    if (page > 0)
+    {
+        AddGossipItemFor(player, GOSSIP_ICON_CHAT, PreviousPageText, OptionId, ((page - 1) << 16) | ACTION_SHOW_PAGE);
+    }
+    // One item past the page tells whether there is a next one
+    if (page < ACTION_SHOW_PAGE && Generator(player, first + pageSize, Scratch))
+    {
+        AddGossipItemFor(player, GOSSIP_ICON_CHAT, NextPageText, OptionId, ((page + 1) << 16) | ACTION_SHOW_PAGE);
+        shown.HasNext = true;
+    }
+    if (standalone)
+    {
+        AddGossipItemFor(player, GOSSIP_ICON_CHAT, BackText, OptionId, ACTION_BACK);
+    }
+
+    Gossip->MarkGeneratorPage(player, shown);
+}
+
+// The list may have changed since it was shown, the callback gets the index as it was then
+bool SimpleGossipOptionGenerator::SelectItem(Player* player, uint32 page, uint32 index)
+{
+    if (index == ACTION_SHOW_PAGE)
+    {
+        return ShowPage(player, page);
+    }
+    if (index == ACTION_BACK)
+    {
+        return Gossip->ShowCurrentPage(player);
+    }
+
+    uint32 pageSize = std::min(std::max(PageSize, 1u), MAX_PAGE_SIZE);
+    if (index >= pageSize || GeneratorCallback == nullptr)
+    {
+        return false;
+    }
+
+    GeneratorCallback(player, page * pageSize + index, this);
+    SimpleGossipOption::SelectOption(player);
+
+    return true;
+}
+
+SimpleGossipOptionAsync::SimpleGossipOptionAsync(
+    GossipOptionIcon icon,
+    SimpleGossipText text,
+    SGAsyncCallback callback)
+{
+    Icon = icon;
+    Text = text;
+    AsyncCallback = callback;
+}
+
+bool SimpleGossipOptionAsync::ShowOption(Player* player)
+{
+    if (ConditionallyShow != nullptr && !SIMPLEGOSSIP_PROFILE_CONDITION(this, ConditionallyShow(player, this)))
+    {
+        return false;
+    }
+    SIMPLEGOSSIP_PROFILE_COUNT(this, Renders);
+    LocaleConstant locale = SimpleGossipStrings::GetLocale(player);
+    if (PopupText.IsEmpty())
+    {
+        AddGossipItemFor(player, Icon, Text.Get(locale), GOSSIP_SENDER_MAIN, OptionId);
+    }
+    else
+    {
+        AddGossipItemFor(player, Icon, Text.Get(locale), GOSSIP_SENDER_MAIN, OptionId, PopupText.Get(locale), 0, false);
+    }
+    Gossip->MarkShown(player, OptionId);
+    return true;
+}
+
+// Only starts the work, SimpleGossip::ResumeAsync does the rest of SelectOption once it completed
+bool SimpleGossipOptionAsync::SelectOption(Player* player)
+{
+    if (AsyncCallback == nullptr)
+    {
+        return false;
+    }
+
+    Gossip->AddPendingAsync(player, this, AsyncCallback(player, this));
+
     return true;
 }
 
@@ -180,14 +346,15 @@ bool SimpleGossipOptionDatabaseMenu::ShowOption(Player* player)
 
 bool SimpleGossipPart::ShowPart(Player* player)
 {
-    if (ConditionallyShow != nullptr && !ConditionallyShow(player, this))
+    if (ConditionallyShow != nullptr && !SIMPLEGOSSIP_PROFILE_CONDITION(this, ConditionallyShow(player, this)))
     {
         return false;
     }
+    SIMPLEGOSSIP_PROFILE_COUNT(this, Renders);
 
-    for (std::vector<uint32>::iterator itr = OptionIds.begin(); itr != OptionIds.end(); ++itr)
+    for (uint32 optionId : OptionIds)
     {
-        SimpleGossipOption* option = Gossip->GetOptionById(*itr);
+        SimpleGossipOption* option = Gossip->GetOptionById(optionId);
         if (option == nullptr)
         {
             return false;
@@ -206,24 +373,79 @@ void SimpleGossipPart::AddOption(SimpleGossipOption* option)
 
 void SimpleGossipPart::AddOptionId(uint32 optionId)
 {
-    OptionIds.push_back(optionId);
+    AddOptionIds(SimpleGossipIdSpan(&optionId, 1));
+}
+
+void SimpleGossipPart::AddOptionIds(SimpleGossipIdSpan optionIds)
+{
+    if (Gossip != nullptr)
+    {
+        Gossip->Invalidate();
+        for (uint32 optionId : optionIds)
+        {
+            Gossip->IndexOption(optionId, PartId);
+        }
+    }
+    OptionIds.insert(OptionIds.end(), optionIds.begin(), optionIds.end());
 }
 
 bool SimpleGossipPart::RemoveOptionId(uint32 optionId)
 {
-    std::vector<uint32> optionIdToRemove{ optionId };
-    std::vector<uint32>::iterator it = optionIdToRemove.begin();
-    uint32 size = OptionIds.size();
-    OptionIds.erase(it);
-    return size != OptionIds.size();
+    return RemoveOptionIds(SimpleGossipIdSpan(&optionId, 1)) != 0;
+}
+
+size_t SimpleGossipPart::RemoveOptionIds(SimpleGossipIdSpan optionIds)
+{
+    if (Gossip != nullptr)
+    {
+        Gossip->Invalidate();
+    }
+
+    std::vector<uint32> removed(optionIds.begin(), optionIds.end());
+    std::sort(removed.begin(), removed.end());
+
+    std::vector<uint32> hits;
+    size_t size = OptionIds.size();
+    OptionIds.erase(std::remove_if(OptionIds.begin(), OptionIds.end(), [&removed, &hits](uint32 optionId)
+    {
+        if (!std::binary_search(removed.begin(), removed.end(), optionId))
+        {
+            return false;
+        }
+        hits.push_back(optionId);
+        return true;
+    }), OptionIds.end());
+
+    // UnindexOption drops every listing of the part at once, listed twice is unindexed once
+    if (Gossip != nullptr)
+    {
+        std::sort(hits.begin(), hits.end());
+        hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+        for (uint32 optionId : hits)
+        {
+            Gossip->UnindexOption(optionId, PartId);
+        }
+    }
+    return size - OptionIds.size();
 }
 
 bool SimpleGossipPart::Clear()
 {
+    if (Gossip != nullptr)
+    {
+        Gossip->Invalidate();
+    }
     if (OptionIds.size() == 0)
     {
         return false;
     }
+    if (Gossip != nullptr)
+    {
+        for (uint32 optionId : OptionIds)
+        {
+            Gossip->UnindexOption(optionId, PartId);
+        }
+    }
     OptionIds.clear();
     return OptionIds.size() == 0;
 }
@@ -232,251 +454,853 @@ bool SimpleGossipPart::Clear()
 // ********************************* Simple Gossip ********************************* //
 ///////////////////////////////////////////////////////////////////////////////////////
 
+SimpleGossip::SimpleGossip()
+{
+    sSimpleGossipState->RegisterGossip(this);
+}
+
 SimpleGossip::~SimpleGossip()
 {
-    for (std::unordered_map<uint32, SimpleGossipPart*>::iterator itr = Parts.begin(); itr != Parts.end(); ++itr)
-    {
-        delete& itr->second;
-    }
-    for (std::unordered_map<uint32, SimpleGossipOption*>::iterator itr = Options.begin(); itr != Options.end(); ++itr)
-    {
-        delete& itr->second;
-    }
+    sSimpleGossipState->UnregisterGossip(this);
+    Clear();
 }
 
 bool SimpleGossip::StartGossip(Player* player, ObjectGuid sender)
 {
-    bool show = ShowParts(player, StartingPartIds);
-    return show;
+    StartSession(player, sender);
+    if (Finalized)
+    {
+        return ShowPage(player, sender, StartingTextId, StartingPage);
+    }
+    return ShowParts(player, sender, StartingTextId, StartingPartIds);
 }
 bool SimpleGossip::StartGossip(Player* player, Creature* sender)
 {
-    bool show = ShowParts(player, sender, StartingPartIds);
-    return show;
+    return StartGossip(player, sender->GetGUID());
 }
-bool SimpleGossip::ShowParts(Player* player, ObjectGuid sender, std::vector<uint32> parts)
+bool SimpleGossip::ShowParts(Player* player, ObjectGuid sender, SimpleGossipIdSpan parts)
 {
     return ShowParts(player, sender, StartingTextId, parts);
 }
-bool SimpleGossip::ShowParts(Player* player, ObjectGuid sender, uint32 textId, std::vector<uint32> parts)
+bool SimpleGossip::ShowParts(Player* player, ObjectGuid sender, uint32 textId, SimpleGossipIdSpan parts)
 {
     ClearGossipMenuFor(player);
     CloseGossipMenuFor(player);
+    BeginRender(player, sender);
 
-    for (std::vector<uint32>::iterator itr = parts.begin(); itr != parts.end(); ++itr)
+    for (uint32 partId : parts)
     {
-        SimpleGossipPart* part = GetPartById(*itr);
+        SimpleGossipPart* part = GetPartById(partId);
         if (part == nullptr) {
             return false;
         }
         part->ShowPart(player);
     }
 
-    SendGossipMenuFor(player, StartingTextId, sender);
+    SendGossipMenuFor(player, textId, sender);
 
     return true;
 }
-bool SimpleGossip::ShowParts(Player* player, Creature* sender, std::vector<uint32> parts)
+bool SimpleGossip::ShowParts(Player* player, Creature* sender, SimpleGossipIdSpan parts)
 {
     return ShowParts(player, sender, StartingTextId, parts);
 }
-bool SimpleGossip::ShowParts(Player* player, Creature* sender, uint32 textId, std::vector<uint32> parts)
+bool SimpleGossip::ShowParts(Player* player, Creature* sender, uint32 textId, SimpleGossipIdSpan parts)
+{
+    return ShowParts(player, sender->GetGUID(), textId, parts);
+}
+bool SimpleGossip::ShowParts(Player* player, SimpleGossipIdSpan parts)
+{
+    return ShowParts(player, StartingTextId, parts);
+}
+bool SimpleGossip::ShowParts(Player* player, uint32 textId, SimpleGossipIdSpan parts)
+{
+    return ShowParts(player, GetSender(player), textId, parts);
+}
+// Restarting forgets where the player came from
+bool SimpleGossip::ShowStartingParts(Player* player)
+{
+    ObjectGuid sender = GetSender(player);
+    if (SimpleGossipSession* session = GetSession(player))
+    {
+        session->Reset(sender);
+    }
+    if (Finalized)
+    {
+        return ShowPage(player, sender, StartingTextId, StartingPage);
+    }
+    return ShowParts(player, sender, StartingTextId, StartingPartIds);
+}
+
+// Moving to another page remembers the one the player leaves, for ShowPreviousPage
+bool SimpleGossip::ShowPage(Player* player, ObjectGuid sender, uint32 textId, uint32 page)
+{
+    if (!SendPage(player, sender, textId, page))
+    {
+        return false;
+    }
+
+    if (SimpleGossipSession* session = GetSession(player))
+    {
+        if (session->Current.Page != SIMPLEGOSSIP_NO_PAGE && session->Current.Page != page)
+        {
+            session->Push(session->Current);
+        }
+        session->Current = { page, textId };
+    }
+    return true;
+}
+bool SimpleGossip::ShowPage(Player* player, uint32 textId, uint32 page)
+{
+    return ShowPage(player, GetSender(player), textId, page);
+}
+
+bool SimpleGossip::ShowCurrentPage(Player* player)
+{
+    SimpleGossipSession* session = GetSession(player);
+    if (session == nullptr || session->Current.Page == SIMPLEGOSSIP_NO_PAGE)
+    {
+        return ShowStartingParts(player);
+    }
+    return SendPage(player, session->Sender, session->Current.TextId, session->Current.Page);
+}
+
+bool SimpleGossip::ShowPreviousPage(Player* player)
+{
+    SimpleGossipSession* session = GetSession(player);
+    SimpleGossipSession::Visit visit;
+    if (session == nullptr || !session->Pop(visit))
+    {
+        return ShowStartingParts(player);
+    }
+
+    session->Current = visit;
+    return SendPage(player, session->Sender, visit.TextId, visit.Page);
+}
+
+SimpleGossipSession* SimpleGossip::StartSession(Player* player, ObjectGuid sender)
+{
+    SimpleGossipSession*& session = Sessions[player->GetGUID()];
+    if (session == nullptr)
+    {
+        if (!FreeSessions.empty())
+        {
+            session = FreeSessions.back();
+            FreeSessions.pop_back();
+        }
+        else
+        {
+            SessionStorage.emplace_back();
+            session = &SessionStorage.back();
+        }
+    }
+    session->Reset(sender);
+    return session;
+}
+
+SimpleGossipSession* SimpleGossip::GetSession(Player* player)
+{
+    auto itr = Sessions.find(player->GetGUID());
+    return itr != Sessions.end() ? itr->second : nullptr;
+}
+
+void SimpleGossip::EndSession(ObjectGuid guid)
+{
+    auto itr = Sessions.find(guid);
+    if (itr == Sessions.end())
+    {
+        return;
+    }
+    FreeSessions.push_back(itr->second);
+    Sessions.erase(itr);
+}
+
+ObjectGuid SimpleGossip::GetSender(Player* player)
+{
+    if (SimpleGossipSession* session = GetSession(player))
+    {
+        return session->Sender;
+    }
+    return player->PlayerTalkClass->GetGossipMenu().GetSenderGUID();
+}
+
+SimpleGossipSession* SimpleGossip::BeginRender(Player* player, ObjectGuid sender)
+{
+    SimpleGossipSession* session = GetSession(player);
+    if (session == nullptr)
+    {
+        return StartSession(player, sender);
+    }
+    session->ClearShown();
+    return session;
+}
+
+void SimpleGossip::MarkShown(Player* player, uint32 optionId)
+{
+    if (SimpleGossipSession* session = GetSession(player))
+    {
+        session->MarkShown(optionId);
+    }
+}
+
+void SimpleGossip::MarkGeneratorPage(Player* player, SimpleGossipSession::GeneratorPage const& page)
+{
+    if (SimpleGossipSession* session = GetSession(player))
+    {
+        session->MarkGeneratorPage(page);
+    }
+}
+
+bool SimpleGossip::WasShown(Player* player, uint32 optionId)
+{
+    SimpleGossipSession* session = GetSession(player);
+    return session != nullptr && session->WasShown(optionId);
+}
+
+bool SimpleGossip::SendPage(Player* player, ObjectGuid sender, uint32 textId, uint32 page)
 {
+    if (!Finalized || page >= Pages.size() || !Pages[page].Valid)
+    {
+        return false;
+    }
+
     ClearGossipMenuFor(player);
     CloseGossipMenuFor(player);
+    SimpleGossipSession* session = BeginRender(player, sender);
+    SIMPLEGOSSIP_PROFILE_COUNT(this, Renders);
 
-    for (std::vector<uint32>::iterator itr = parts.begin(); itr != parts.end(); ++itr)
+    if (Pages[page].Encoded)
     {
-        SimpleGossipPart* part = GetPartById(*itr);
-        if (part == nullptr) {
-            return false;
-        }
-        part->ShowPart(player);
+        SendEncodedPage(player, session, sender, textId, page);
+        return true;
     }
 
-    SendGossipMenuFor(player, StartingTextId, sender);
+    RenderPage(player, session, page);
+
+    SendGossipMenuFor(player, textId, sender);
 
     return true;
 }
-bool SimpleGossip::ShowParts(Player* player, std::vector<uint32> parts)
+
+// Custom options mark themselves in ShowOption
+void SimpleGossip::RenderPage(Player* player, SimpleGossipSession* session, uint32 page)
 {
-    return ShowParts(player, StartingTextId, parts);
+    LocaleConstant locale = SimpleGossipStrings::GetLocale(player);
+    for (uint32 index : GetVisibleItems(player, page))
+    {
+        SimpleGossipPageItem const& item = PageItems[index];
+        if (item.Type != SIMPLEGOSSIP_ITEM_CUSTOM)
+        {
+            SIMPLEGOSSIP_PROFILE_COUNT(item.Option, Renders);
+            session->MarkShown(item.OptionId);
+        }
+        switch (item.Type)
+        {
+            case SIMPLEGOSSIP_ITEM_ICON_TEXT:
+                AddGossipItemFor(player, item.Icon, item.Text.Get(locale), GOSSIP_SENDER_MAIN, item.OptionId);
+                break;
+            case SIMPLEGOSSIP_ITEM_ICON_TEXT_POPUP:
+                AddGossipItemFor(player, item.Icon, item.Text.Get(locale), GOSSIP_SENDER_MAIN, item.OptionId, item.PopupText.Get(locale), item.PopupCopper, item.IsCoded);
+                break;
+            case SIMPLEGOSSIP_ITEM_DATABASE_MENU:
+                AddGossipItemFor(player, item.PopupCopper, item.MenuItemId, GOSSIP_SENDER_MAIN, item.OptionId);
+                break;
+            default:
+                item.Option->ShowOption(player);
+                break;
+        }
+    }
+}
+
+// Builds SMSG_GOSSIP_MESSAGE the same way PlayerMenu::SendGossipMenu does, but copies the pre-encoded item bytes.
+// The server side menu still gets every item so option selection keeps working, only without their texts.
+void SimpleGossip::SendEncodedPage(Player* player, SimpleGossipSession* session, ObjectGuid sender, uint32 textId, uint32 page)
+{
+    GossipMenu& menu = player->PlayerTalkClass->GetGossipMenu();
+    LocaleConstant locale = SimpleGossipStrings::GetLocale(player);
+    std::vector<uint8> const& bytes = PageBytes[locale];
+
+    std::vector<uint32> const& items = GetVisibleItems(player, page);
+
+    WorldPacket data(SMSG_GOSSIP_MESSAGE, 8 + 4 + 4 + 4 + 4 + items.size() * 64);
+    data << sender;
+    data << uint32(menu.GetMenuId());
+    data << uint32(textId);
+    size_t countPos = data.wpos();
+    data << uint32(0);
+
+    uint32 count = 0;
+    for (uint32 index : items)
+    {
+        SimpleGossipPageItem const& item = PageItems[index];
+        SIMPLEGOSSIP_PROFILE_COUNT(item.Option, Renders);
+        session->MarkShown(item.OptionId);
+        menu.AddMenuItem(-1, item.Icon, "", GOSSIP_SENDER_MAIN, item.OptionId, "", item.PopupCopper, item.IsCoded);
+        data << uint32(count++);
+        data.append(bytes.data() + item.FragmentOffset[locale], item.FragmentSize[locale]);
+    }
+
+    data.put<uint32>(countPos, count);
+    data << uint32(0);                  // quests, never added to coded menus
+
+    menu.SetSenderGUID(sender);
+    player->GetSession()->SendPacket(&data);
 }
-bool SimpleGossip::ShowParts(Player* player, uint32 textId, std::vector<uint32> parts)
+
+// icon, coded, box money, message and box message, exactly as they follow the item index on the wire.
+// Each locale gets the texts of its translation.
+void SimpleGossip::EncodeFragments(SimpleGossipPageItem& item)
 {
-    auto menu = player->PlayerTalkClass->GetGossipMenu();
-    ObjectGuid sender = menu.GetSenderGUID();
-    return ShowParts(player, sender, textId, parts);
+    for (uint8 locale = 0; locale < TOTAL_LOCALES; ++locale)
+    {
+        std::string const& text = item.Text.Get(LocaleConstant(locale));
+        std::string const& popupText = item.PopupText.Get(LocaleConstant(locale));
+        std::vector<uint8>& bytes = PageBytes[locale];
+        item.FragmentOffset[locale] = uint32(bytes.size());
+
+        bytes.push_back(uint8(item.Icon));
+        bytes.push_back(uint8(item.IsCoded));
+        for (uint8 shift = 0; shift < 32; shift += 8)
+        {
+            bytes.push_back(uint8(item.PopupCopper >> shift));
+        }
+        bytes.insert(bytes.end(), text.begin(), text.end());
+        bytes.push_back(0);
+        bytes.insert(bytes.end(), popupText.begin(), popupText.end());
+        bytes.push_back(0);
+
+        item.FragmentSize[locale] = uint32(bytes.size()) - item.FragmentOffset[locale];
+    }
 }
-bool SimpleGossip::ShowStartingParts(Player* player)
+
+// Compiles StartingPartIds and the NextParts of every option into page tables, equal part lists share one page.
+void SimpleGossip::Finalize()
 {
-    auto menu = player->PlayerTalkClass->GetGossipMenu();
-    ObjectGuid sender = menu.GetSenderGUID();
-    return ShowParts(player, sender, StartingTextId, StartingPartIds);
+    Pages.clear();
+    PageParts.clear();
+    PageItems.clear();
+    PageIndex.clear();
+    for (std::vector<uint8>& bytes : PageBytes)
+    {
+        bytes.clear();
+    }
+
+    StartingPage = CompilePage(StartingPartIds);
+    for (SimpleGossipOption* option : Options)
+    {
+        option->NextPage = option->NextParts.empty() ? SIMPLEGOSSIP_NO_PAGE : CompilePage(option->NextParts);
+    }
+
+    PageIndex.clear();
+    RenderCache.clear();
+    // Page indexes change, sessions keep only their sender
+    for (auto& [guid, session] : Sessions)
+    {
+        session->Reset(session->Sender);
+    }
+    ++Generation;
+    Finalized = true;
 }
 
+uint32 SimpleGossip::CompilePage(SimpleGossipIdSpan parts)
+{
+    std::vector<uint32> key(parts.begin(), parts.end());
+    auto itr = PageIndex.find(key);
+    if (itr != PageIndex.end())
+    {
+        return itr->second;
+    }
+
+    SimpleGossipPage page;
+    page.FirstPart = uint32(PageParts.size());
+
+    for (uint32 partId : parts)
+    {
+        SimpleGossipPart* part = GetPartById(partId);
+        if (part == nullptr)
+        {
+            page.Valid = false;
+            break;
+        }
+
+        if (part->ConditionallyShow != nullptr)
+        {
+            page.DependsOn |= part->ConditionDependsOn;
+        }
+
+        SimpleGossipPagePart pagePart;
+        pagePart.Part = part;
+        pagePart.FirstItem = uint32(PageItems.size());
+
+        for (uint32 optionId : part->OptionIds)
+        {
+            // Like ShowPart, a missing option hides the rest of its part
+            SimpleGossipOption* option = GetOptionById(optionId);
+            if (option == nullptr)
+            {
+                break;
+            }
+
+            SimpleGossipPageItem item;
+            item.OptionId = option->OptionId;
+            item.Option = option;
+            item.HasCondition = option->ConditionallyShow != nullptr;
+            if (item.HasCondition)
+            {
+                page.DependsOn |= option->ConditionDependsOn;
+            }
+
+            if (typeid(*option) == typeid(SimpleGossipOptionIconText))
+            {
+                SimpleGossipOptionIconText* iconText = static_cast<SimpleGossipOptionIconText*>(option);
+                item.Type = SIMPLEGOSSIP_ITEM_ICON_TEXT;
+                item.Icon = iconText->Icon;
+                item.Text = iconText->Text;
+            }
+            else if (typeid(*option) == typeid(SimpleGossipOptionIconTextPopup))
+            {
+                SimpleGossipOptionIconTextPopup* popup = static_cast<SimpleGossipOptionIconTextPopup*>(option);
+                item.Type = SIMPLEGOSSIP_ITEM_ICON_TEXT_POPUP;
+                item.Icon = popup->Icon;
+                item.Text = popup->Text;
+                item.PopupText = popup->PopupText;
+                item.PopupCopper = popup->PopupCopper;
+                item.IsCoded = popup->IsCoded;
+            }
+            else if (typeid(*option) == typeid(SimpleGossipOptionDatabaseMenu))
+            {
+                SimpleGossipOptionDatabaseMenu* databaseMenu = static_cast<SimpleGossipOptionDatabaseMenu*>(option);
+                item.Type = SIMPLEGOSSIP_ITEM_DATABASE_MENU;
+                item.PopupCopper = databaseMenu->MenuId;
+                item.MenuItemId = databaseMenu->MenuItemId;
+            }
+
+            // Database menu texts are localized by the core and custom options render themselves
+            if (item.Type == SIMPLEGOSSIP_ITEM_ICON_TEXT || item.Type == SIMPLEGOSSIP_ITEM_ICON_TEXT_POPUP)
+            {
+                EncodeFragments(item);
+            }
+            else
+            {
+                page.Encoded = false;
+            }
+
+            PageItems.push_back(std::move(item));
+            ++pagePart.ItemCount;
+        }
+
+        PageParts.push_back(pagePart);
+        ++page.PartCount;
+    }
+
+    uint32 index = uint32(Pages.size());
+    Pages.push_back(page);
+    PageIndex[key] = index;
+    return index;
+}
+
+// Reuses the items the player saw last time when it is the same page and none of the states its conditions read changed.
+// Pages with a condition that does not declare its states are evaluated every time.
+std::vector<uint32> const& SimpleGossip::GetVisibleItems(Player* player, uint32 page)
+{
+    SimpleGossipPage const& compiled = Pages[page];
+    if (compiled.DependsOn & SIMPLEGOSSIP_STATE_UNTRACKED)
+    {
+        UncachedItems.clear();
+        CollectVisibleItems(player, compiled, UncachedItems);
+        return UncachedItems;
+    }
+
+    SimpleGossipStateVersions const& versions = sSimpleGossipState->Get(player);
+    SimpleGossipRenderCache& cache = RenderCache[player->GetGUID()];
+    if (cache.Page == page && cache.Generation == Generation && cache.Versions.Matches(versions, compiled.DependsOn))
+    {
+        SIMPLEGOSSIP_PROFILE_COUNT(this, CacheHits);
+        return cache.Items;
+    }
+    SIMPLEGOSSIP_PROFILE_COUNT(this, CacheMisses);
+
+    cache.Page = page;
+    cache.Generation = Generation;
+    cache.Versions = versions;
+    cache.Items.clear();
+    CollectVisibleItems(player, compiled, cache.Items);
+    return cache.Items;
+}
+
+void SimpleGossip::CollectVisibleItems(Player* player, SimpleGossipPage const& page, std::vector<uint32>& items)
+{
+    for (uint32 p = page.FirstPart; p < page.FirstPart + page.PartCount; ++p)
+    {
+        SimpleGossipPagePart const& pagePart = PageParts[p];
+        if (pagePart.Part->ConditionallyShow != nullptr && !SIMPLEGOSSIP_PROFILE_CONDITION(pagePart.Part, pagePart.Part->ConditionallyShow(player, pagePart.Part)))
+        {
+            continue;
+        }
+
+        for (uint32 i = pagePart.FirstItem; i < pagePart.FirstItem + pagePart.ItemCount; ++i)
+        {
+            if (!PageItems[i].HasCondition || SIMPLEGOSSIP_PROFILE_CONDITION(PageItems[i].Option, PageItems[i].Option->ConditionallyShow(player, PageItems[i].Option)))
+            {
+                items.push_back(i);
+            }
+        }
+    }
+}
+
+// One bit test per select, a forged option id never reaches GetOptionById
 bool SimpleGossip::SelectGossipOption(Player* player, uint32 option)
 {
+    SimpleGossipSession* session = GetSession(player);
+    if (session == nullptr || !session->WasShown(option))
+    {
+        return false;
+    }
+    // The menu is gone once something is picked, whatever the option shows next marks its own items
+    session->ClearShown();
+
     ClearGossipMenuFor(player);
     SimpleGossipOption* gossipOption = GetOptionById(option);
-    return gossipOption != nullptr && gossipOption->SelectOption(player);
+    return gossipOption != nullptr && SIMPLEGOSSIP_PROFILE_SELECT(gossipOption, gossipOption->SelectOption(player));
 }
 
-bool SimpleGossip::CloseGossip(Player* player)
+bool SimpleGossip::SelectGossipOption(Player* player, uint32 sender, uint32 action)
 {
-    CloseGossipMenuFor(player);
-    return true;
+    if (sender == GOSSIP_SENDER_MAIN)
+    {
+        return SelectGossipOption(player, action);
+    }
+
+    // Only the page the generator sent can be selected from, not any page a forged action names
+    SimpleGossipSession* session = GetSession(player);
+    if (session == nullptr || !session->WasShown(sender)
+        || !session->WasGeneratorItemShown(sender, action >> 16, action & 0xFFFF))
+    {
+        return false;
+    }
+
+    // Slot map ids never fit in the low bits alone, so a generator id can't be mistaken for GOSSIP_SENDER_MAIN
+    SimpleGossipOptionGenerator* generator = dynamic_cast<SimpleGossipOptionGenerator*>(GetOptionById(sender));
+    if (generator == nullptr)
+    {
+        return false;
+    }
+    session->ClearShown();
+    ClearGossipMenuFor(player);
+    return SIMPLEGOSSIP_PROFILE_SELECT(generator, generator->SelectItem(player, action >> 16, action & 0xFFFF));
 }
 
-SimpleGossipPart* SimpleGossip::GetPartById(uint32 partId)
+void SimpleGossip::AddPendingAsync(Player* player, SimpleGossipOptionAsync* option, QueryCallback&& callback)
 {
-    auto search = Parts.find(partId);
-    if (search == Parts.end())
+    SimpleGossipPendingAsync pending{ std::move(callback), player->GetGUID(), 0, option->OptionId };
+
+    // Without a session there is nothing to resume, the work still runs to completion
+    if (SimpleGossipSession* session = GetSession(player))
     {
-        return nullptr;
+        if (++NextAsyncTicket == 0)
+        {
+            ++NextAsyncTicket;
+        }
+        pending.Ticket = NextAsyncTicket;
+        session->AsyncTicket = NextAsyncTicket;
     }
-    return search->second;
+
+    PendingAsync.push_back(std::move(pending));
+    sSimpleGossipState->SchedulePending(this);
 }
 
-SimpleGossipOption* SimpleGossip::GetOptionById(uint32 partId)
+bool SimpleGossip::ProcessAsync()
 {
-    auto search = Options.find(partId);
-    if (search == Options.end())
+    // Resuming may queue more work, that is left for the next update
+    size_t count = PendingAsync.size();
+    for (size_t i = 0; i < count;)
+    {
+        if (!PendingAsync[i].Callback.InvokeIfReady())
+        {
+            ++i;
+            continue;
+        }
+
+        SimpleGossipPendingAsync done = std::move(PendingAsync[i]);
+        PendingAsync.erase(PendingAsync.begin() + i);
+        --count;
+        ResumeAsync(done);
+    }
+    return !PendingAsync.empty();
+}
+
+void SimpleGossip::ResumeAsync(SimpleGossipPendingAsync const& done)
+{
+    if (done.Ticket == 0)
+    {
+        return;
+    }
+
+    Player* player = ObjectAccessor::FindConnectedPlayer(done.Player);
+    SimpleGossipSession* session = player ? GetSession(player) : nullptr;
+    if (session == nullptr || session->AsyncTicket != done.Ticket)
     {
-        return nullptr;
+        return;
     }
-    return search->second;
+    session->AsyncTicket = 0;
+
+    // The option may have been removed while waiting
+    SimpleGossipOption* option = GetOptionById(done.OptionId);
+    if (option == nullptr)
+    {
+        return;
+    }
+
+    ClearGossipMenuFor(player);
+    option->SimpleGossipOption::SelectOption(player);
+}
+
+bool SimpleGossip::CloseGossip(Player* player)
+{
+    EndSession(player->GetGUID());
+    CloseGossipMenuFor(player);
+    return true;
+}
+
+SimpleGossipPart* SimpleGossip::GetPartById(uint32 partId)
+{
+    SimpleGossipPart** part = Parts.Find(partId);
+    return part ? *part : nullptr;
+}
+
+SimpleGossipOption* SimpleGossip::GetOptionById(uint32 optionId)
+{
+    SimpleGossipOption** option = Options.Find(optionId);
+    return option ? *option : nullptr;
 }
 
 SimpleGossipPart* SimpleGossip::AddPart()
 {
-    SimpleGossipPart* part = new SimpleGossipPart();
-    part->PartId = GetNextPartId();
+    Finalized = false;
+    SimpleGossipPart* part = Arena.New<SimpleGossipPart>();
+    part->OptionIds = SimpleGossipIdList(&Arena);
+    part->PartId = Parts.Insert(part);
     part->Gossip = this;
-    Parts[part->PartId] = part;
-    IncremenetNextPartId();
 
     return part;
 }
 
+// Adopts a part allocated outside of the gossip. Parts of another gossip stay with it, their memory belongs to that gossip.
 void SimpleGossip::AddPart(SimpleGossipPart* part)
 {
-    if (part == nullptr || part->Gossip == this)
+    Finalized = false;
+    if (part == nullptr || part->Gossip != nullptr)
     {
         return;
     }
-    if (part->Gossip != nullptr)
+    if (!Arena.Owns(part))
     {
-        part->Gossip->RemoveOption(part->PartId);
+        AdoptedParts.emplace_back(part);
     }
-    part->PartId = GetNextPartId();
+    part->PartId = Parts.Insert(part);
     part->Gossip = this;
-    Parts[part->PartId] = part;
-    IncremenetNextPartId();
+    for (uint32 optionId : part->OptionIds)
+    {
+        IndexOption(optionId, part->PartId);
+    }
 }
 
 bool SimpleGossip::RemovePart(uint32 partId)
 {
-    auto result = Parts.erase(partId);
-
-    return result > 0;
+    Finalized = false;
+    if (SimpleGossipPart* part = GetPartById(partId))
+    {
+        for (uint32 optionId : part->OptionIds)
+        {
+            UnindexOption(optionId, partId);
+        }
+    }
+    return Parts.Erase(partId);
 }
 
+// Adopted parts are deleted, arena parts go back to the arena's free list for the next part.
 bool SimpleGossip::RemoveAndDeletePart(uint32 partId)
 {
+    Finalized = false;
     SimpleGossipPart* part = GetPartById(partId);
     if (part == nullptr)
     {
         return false;
     }
 
-    auto result = Parts.erase(partId);
+    RemovePart(partId);
 
-    delete part;
+    auto adopted = std::find_if(AdoptedParts.begin(), AdoptedParts.end(), [part](std::unique_ptr<SimpleGossipPart> const& p) { return p.get() == part; });
+    if (adopted != AdoptedParts.end())
+    {
+        AdoptedParts.erase(adopted);
+    }
+    else if (Arena.Owns(part))
+    {
+        Arena.Delete(part);
+    }
 
     return true;
 }
 
+// Adopts an option allocated outside of the gossip. Options of another gossip stay with it, their memory belongs to that gossip.
 void SimpleGossip::AddOption(SimpleGossipOption* option)
 {
-    if (option == nullptr || option->Gossip == this)
+    Finalized = false;
+    if (option == nullptr || option->Gossip != nullptr)
     {
         return;
     }
-    if (option->Gossip != nullptr)
+    if (!Arena.Owns(option))
     {
-        option->Gossip->RemoveOption(option->OptionId);
+        AdoptedOptions.emplace_back(option);
     }
-    option->OptionId = GetNextOptionId();
+    option->OptionId = Options.Insert(option);
     option->Gossip = this;
-    Options[option->OptionId] = option;
-    IncremenetNextOptionId();
 }
 
 bool SimpleGossip::RemoveOption(uint32 optionId)
 {
-    auto result = Options.erase(optionId);
+    return RemoveOptions(SimpleGossipIdSpan(&optionId, 1), false) != 0;
+}
 
-    for (std::unordered_map<uint32, SimpleGossipPart*>::iterator itr = Parts.begin(); itr != Parts.end(); ++itr)
-    {
-        itr->second->RemoveOptionId(optionId);
-    }
+bool SimpleGossip::RemoveAndDeleteOption(uint32 optionId)
+{
+    return RemoveOptions(SimpleGossipIdSpan(&optionId, 1), true) != 0;
+}
 
-    return result > 0;
+size_t SimpleGossip::RemoveOptions(SimpleGossipIdSpan optionIds)
+{
+    return RemoveOptions(optionIds, false);
 }
 
-bool SimpleGossip::RemoveAndDeleteOption(uint32 optionId)
+size_t SimpleGossip::RemoveAndDeleteOptions(SimpleGossipIdSpan optionIds)
 {
-    SimpleGossipOption* option = GetOptionById(optionId);
-    if (option == nullptr)
+    return RemoveOptions(optionIds, true);
+}
+
+// Only the parts the index lists for the options are touched, each of them once however many of its options go
+size_t SimpleGossip::RemoveOptions(SimpleGossipIdSpan optionIds, bool deleteOptions)
+{
+    Finalized = false;
+
+    std::vector<uint32> partIds;
+    for (uint32 optionId : optionIds)
     {
-        return false;
+        auto itr = OptionParts.find(optionId);
+        if (itr != OptionParts.end())
+        {
+            partIds.insert(partIds.end(), itr->second.begin(), itr->second.end());
+        }
     }
+    std::sort(partIds.begin(), partIds.end());
+    partIds.erase(std::unique(partIds.begin(), partIds.end()), partIds.end());
 
-    auto result = Options.erase(optionId);
-
-    for (std::unordered_map<uint32, SimpleGossipPart*>::iterator itr = Parts.begin(); itr != Parts.end(); ++itr)
+    for (uint32 partId : partIds)
     {
-        itr->second->RemoveOptionId(optionId);
+        if (SimpleGossipPart* part = GetPartById(partId))
+        {
+            part->RemoveOptionIds(optionIds);
+        }
     }
 
-    delete option;
+    size_t removed = 0;
+    std::vector<SimpleGossipOption*> deleted;
+    for (uint32 optionId : optionIds)
+    {
+        // Parts removed from the gossip keep their ids, so some listings may be left
+        OptionParts.erase(optionId);
 
-    return true;
-}
+        SimpleGossipOption* option = GetOptionById(optionId);
+        if (option == nullptr)
+        {
+            continue;
+        }
+        Options.Erase(optionId);
+        ++removed;
+        if (deleteOptions)
+        {
+            deleted.push_back(option);
+        }
 
-bool SimpleGossip::Clear()
-{
-    if (Parts.size() == 0 && Options.size() == 0)
+        // The slot gets reused, an open menu must not select whatever lands in it
+        for (auto& [guid, session] : Sessions)
+        {
+            session->ForgetShown(optionId);
+        }
+    }
+
+    // Arena options go back to the arena's free lists, adopted ones are deleted
+    if (!deleted.empty())
     {
-        return false;
+        for (SimpleGossipOption* option : deleted)
+        {
+            if (Arena.Owns(option))
+            {
+                Arena.Delete(dynamic_cast<void*>(option));
+            }
+        }
+
+        std::sort(deleted.begin(), deleted.end());
+        AdoptedOptions.erase(std::remove_if(AdoptedOptions.begin(), AdoptedOptions.end(), [&deleted](std::unique_ptr<SimpleGossipOption> const& o)
+        {
+            return std::binary_search(deleted.begin(), deleted.end(), o.get());
+        }), AdoptedOptions.end());
     }
 
-    Parts.clear();
-    Options.clear();
+    return removed;
+}
 
-    return Parts.size() == 0 && Options.size() == 0;
+void SimpleGossip::IndexOption(uint32 optionId, uint32 partId)
+{
+    OptionParts[optionId].push_back(partId);
 }
 
-bool SimpleGossip::ClearAndDelete()
+void SimpleGossip::UnindexOption(uint32 optionId, uint32 partId)
 {
-    if (Parts.size() == 0 && Options.size() == 0)
+    auto itr = OptionParts.find(optionId);
+    if (itr == OptionParts.end())
     {
-        return false;
+        return;
     }
 
-    for (std::unordered_map<uint32, SimpleGossipPart*>::iterator itr = Parts.begin(); itr != Parts.end(); ++itr)
+    std::vector<uint32>& partIds = itr->second;
+    partIds.erase(std::remove(partIds.begin(), partIds.end(), partId), partIds.end());
+    if (partIds.empty())
     {
-        delete itr->second;
+        OptionParts.erase(itr);
     }
-    for (std::unordered_map<uint32, SimpleGossipOption*>::iterator itr = Options.begin(); itr != Options.end(); ++itr)
+}
+
+SimpleGossipIdSpan SimpleGossip::GetPartsOfOption(uint32 optionId) const
+{
+    auto itr = OptionParts.find(optionId);
+    return itr != OptionParts.end() ? SimpleGossipIdSpan(itr->second) : SimpleGossipIdSpan();
+}
+
+// Frees every part and option in one go. Ids handed out before keep failing to resolve, so menus still open on a client stay harmless.
+bool SimpleGossip::Clear()
+{
+    Finalized = false;
+    bool hadContent = !Parts.Empty() || !Options.Empty();
+
+    Parts.Clear();
+    Options.Clear();
+    OptionParts.clear();
+    for (auto& [guid, session] : Sessions)
     {
-        delete itr->second;
+        session->ClearShown();
     }
-    Parts.clear();
-    Options.clear();
+    AdoptedParts.clear();
+    AdoptedOptions.clear();
+    Arena.Release();
+
+    return hadContent;
+}
 
-    return Parts.size() == 0 && Options.size() == 0;
+bool SimpleGossip::ClearAndDelete()
+{
+    return Clear();
 }
 
 bool CONDITIONALLY_SHOW_TRUE(Player* player, SimpleGossipOption* option)
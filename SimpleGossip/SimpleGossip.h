@@ -5,8 +5,18 @@
 
 #include "GossipDef.h"
 #include "Player.h"
-#include <unordered_map>
+#include "QueryCallback.h"
+#include "SimpleGossipArena.h"
+#include "SimpleGossipProfiler.h"
+#include "SimpleGossipSlotMap.h"
+#include "SimpleGossipState.h"
+#include "SimpleGossipStrings.h"
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 
 class SimpleGossip;
 class SimpleGossipPart;
@@ -14,12 +24,18 @@ class SimpleGossipOption;
 class SimpleGossipOptionIconText;
 class SimpleGossipOptionIconTextPopup;
 class SimpleGossipOptionDatabaseMenu;
+class SimpleGossipOptionGenerator;
+class SimpleGossipOptionAsync;
+struct SimpleGossipGeneratedItem;
 
 typedef std::function<void(Player* player, SimpleGossipOption* option)> SGBaseCallback;
 typedef std::function<bool(Player* player, SimpleGossipOption* option)> SGConditionallyShow;
 typedef std::function<void(Player* player, SimpleGossipOptionIconText* option)> SGIconTextCallback;
 typedef std::function<void(Player* player, bool success, SimpleGossipOptionIconTextPopup* option)> SGIconTextPopupCallback;
 typedef std::function<void(Player* player, SimpleGossipOptionDatabaseMenu* option)> SGDatabaseMenuCallback;
+typedef std::function<bool(Player* player, uint32 index, SimpleGossipGeneratedItem& item)> SGGenerator;
+typedef std::function<void(Player* player, uint32 index, SimpleGossipOptionGenerator* option)> SGGeneratorCallback;
+typedef std::function<QueryCallback(Player* player, SimpleGossipOptionAsync* option)> SGAsyncCallback;
 
 bool CONDITIONALLY_SHOW_TRUE(Player* player, SimpleGossipOption* option);
 bool CONDITIONALLY_SHOW_FALSE(Player* player, SimpleGossipOption* option);
@@ -35,21 +51,31 @@ void DONOTHING_DATABASEMENU(Player* player, SimpleGossipOptionDatabaseMenu* opti
 //typedef SimpleGossipOptionIconTextPopup::SGIconTextPopupCallback SGIconTextPopupCallback;
 //typedef SimpleGossipOptionDatabaseMenu::SGDatabaseMenuCallback SGDatabaseMenuCallback;
 
+constexpr uint32 SIMPLEGOSSIP_NO_PAGE = 0xFFFFFFFF;
+
 class SimpleGossipOption
 {
 public:
     SimpleGossipOption() = default;
+    virtual ~SimpleGossipOption() = default;
 
     SimpleGossip* Gossip = nullptr;
 	uint32 OptionId = 0;
     uint32 NextTextId = 0;
-    std::vector<uint32> NextParts;
+    SimpleGossipIdList NextParts;
+    uint32 NextPage = SIMPLEGOSSIP_NO_PAGE; // Page compiled from NextParts by SimpleGossip::Finalize
     bool RestartOnSelect = true;
     bool CloseDialogOnSelect = false;
+    bool GoBack = false;                // Returns to the page the player saw before, instead of NextParts or restarting
 
     SGConditionallyShow ConditionallyShow = nullptr;
+    uint32 ConditionDependsOn = SIMPLEGOSSIP_STATE_UNTRACKED;  // SimpleGossipState flags ConditionallyShow reads
     SGBaseCallback BaseCallback = nullptr;
 
+#ifdef SIMPLEGOSSIP_PROFILER
+    SimpleGossipProfile Profile;
+#endif
+
 	virtual bool ShowOption(Player* player);
 	virtual bool SelectOption(Player* player);
 };
@@ -60,11 +86,11 @@ public:
     SGIconTextCallback IconTextCallback = nullptr;
 
 	GossipOptionIcon Icon;
-	std::string Text;
+	SimpleGossipText Text;
 
     SimpleGossipOptionIconText(
         GossipOptionIcon icon,
-        std::string text,
+        SimpleGossipText text,
         SGIconTextCallback callback);
 
 	bool ShowOption(Player* player);
@@ -77,21 +103,21 @@ public:
     SGIconTextPopupCallback IconTextPopupCallback = nullptr;
 
 	GossipOptionIcon Icon;
-	std::string Text;
-	std::string PopupText;
+	SimpleGossipText Text;
+	SimpleGossipText PopupText;
 	uint32 PopupCopper;
 	bool IsCoded = false;
 
 	SimpleGossipOptionIconTextPopup(
 		GossipOptionIcon icon,
-		std::string text,
-		std::string popupText,
+		SimpleGossipText text,
+		SimpleGossipText popupText,
 		uint32 popupCopper,
         SGIconTextPopupCallback callback);
 	SimpleGossipOptionIconTextPopup(
 		GossipOptionIcon icon,
-		std::string text,
-		std::string popupText,
+		SimpleGossipText text,
+		SimpleGossipText popupText,
 		uint32 popupGold,
 		uint8 popupSilver,
 		uint8 popupCopper,
@@ -118,6 +144,80 @@ public:
 	bool SelectOption(Player* player);
 };
 
+// What a generator fills in for one list item, reused between items so rendering does not allocate
+struct SimpleGossipGeneratedItem
+{
+    GossipOptionIcon Icon = GOSSIP_ICON_CHAT;
+    std::string Text;
+    std::string PopupText;              // Confirmation box, empty for none
+    bool IsCoded = false;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// An option standing for a list generated on demand, one page at a time.
+// Generator is asked for the items of the shown page only, by absolute index, and returns
+// false past the end of the list. Generated items are sent with the generator's OptionId as
+// gossip sender and page << 16 | index as action, so nothing is registered per item.
+// The first page is shown inline in its part, Next and Previous show the other pages on
+// their own with a way back. Selecting an item runs GeneratorCallback with its absolute
+// index and then continues like any option.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SimpleGossipOptionGenerator : public SimpleGossipOption
+{
+public:
+	static constexpr uint32 ACTION_SHOW_PAGE = 0xFFFF;
+	static constexpr uint32 ACTION_BACK = 0xFFFE;
+	static constexpr uint32 MAX_PAGE_SIZE = 29;     // The client shows 32 items, leaving room for Previous, Next and Back
+
+	SGGenerator Generator;
+	SGGeneratorCallback GeneratorCallback;
+
+	uint32 PageSize = 20;
+	uint32 PageTextId = 0;              // Text of the pages past the first one, 0 uses the gossip's starting text
+	std::string NextPageText = "Next page";
+	std::string PreviousPageText = "Previous page";
+	std::string BackText = "Back";
+
+	SimpleGossipOptionGenerator(
+		SGGenerator generator,
+		SGGeneratorCallback callback);
+
+	bool ShowOption(Player* player);
+	bool SelectOption(Player* player);
+
+	bool ShowPage(Player* player, uint32 page);
+	bool SelectItem(Player* player, uint32 page, uint32 index);
+
+private:
+	void AddItems(Player* player, uint32 page, bool standalone);
+	SimpleGossipGeneratedItem Scratch;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// An option whose callback starts database work and returns its QueryCallback chain.
+// The gossip keeps the chain and continues with the option's next page only once all of it
+// ran, polled from the world update, so the page shows settled state without blocking.
+// If the player closed or restarted the gossip, or logged out, in the meantime the chain
+// still runs but nothing is shown. Chained callbacks should hold the player's guid only.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SimpleGossipOptionAsync : public SimpleGossipOption
+{
+public:
+	SGAsyncCallback AsyncCallback;
+
+	GossipOptionIcon Icon;
+	SimpleGossipText Text;
+	SimpleGossipText PopupText;         // Confirmation box, empty for none
+
+	SimpleGossipOptionAsync(
+		GossipOptionIcon icon,
+		SimpleGossipText text,
+		SGAsyncCallback callback);
+
+	bool ShowOption(Player* player);
+	bool SelectOption(Player* player);
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 // A single part of a gossip menu.
 // It contains references to options which it will display.
@@ -132,49 +232,327 @@ public:
 	SimpleGossip* Gossip = nullptr;
 	uint32 PartId = 0;
 
-	std::vector<uint32> OptionIds;
+	SimpleGossipIdList OptionIds;
 
-	bool (*ConditionallyShow)(Player* player, SimpleGossipPart* option);
+	bool (*ConditionallyShow)(Player* player, SimpleGossipPart* option) = nullptr;
+	uint32 ConditionDependsOn = SIMPLEGOSSIP_STATE_UNTRACKED;  // SimpleGossipState flags ConditionallyShow reads
 
+#ifdef SIMPLEGOSSIP_PROFILER
+	SimpleGossipProfile Profile;
+#endif
+
+	// Edit OptionIds through these, they keep the gossip's option -> parts index up to date
 	bool ShowPart(Player* player);
 	void AddOption(SimpleGossipOption* option);
 	void AddOptionId(uint32 optionId);
+	void AddOptionIds(SimpleGossipIdSpan optionIds);
 	bool RemoveOptionId(uint32 optionId);
+	// One pass over OptionIds, the remaining ids keep their order
+	size_t RemoveOptionIds(SimpleGossipIdSpan optionIds);
 	bool Clear();
 };
 
+////////////////////////////////////////////////////////////////////////////////////////////
+// Page tables built by SimpleGossip::Finalize.
+// A page is the flattened list of parts shown together, with the display data of every
+// option copied inline, so rendering it is a linear scan without any id lookups.
+////////////////////////////////////////////////////////////////////////////////////////////
+
+enum SimpleGossipPageItemType : uint8
+{
+    SIMPLEGOSSIP_ITEM_ICON_TEXT,
+    SIMPLEGOSSIP_ITEM_ICON_TEXT_POPUP,
+    SIMPLEGOSSIP_ITEM_DATABASE_MENU,
+    SIMPLEGOSSIP_ITEM_CUSTOM,           // Option types overriding ShowOption, rendered through it
+};
+
+struct SimpleGossipPageItem
+{
+    SimpleGossipPageItemType Type = SIMPLEGOSSIP_ITEM_CUSTOM;
+    GossipOptionIcon Icon = GOSSIP_ICON_CHAT;
+    bool IsCoded = false;
+    bool HasCondition = false;
+    uint32 OptionId = 0;
+    uint32 PopupCopper = 0;             // MenuId for database menu items
+    uint32 MenuItemId = 0;
+    SimpleGossipText Text;
+    SimpleGossipText PopupText;
+    SimpleGossipOption* Option = nullptr;
+
+    // Pre-encoded SMSG_GOSSIP_MESSAGE bytes of the item after its index, in SimpleGossip::PageBytes
+    uint32 FragmentOffset[TOTAL_LOCALES] = { };
+    uint32 FragmentSize[TOTAL_LOCALES] = { };
+};
+
+struct SimpleGossipPagePart
+{
+    SimpleGossipPart* Part = nullptr;
+    uint32 FirstItem = 0;
+    uint32 ItemCount = 0;
+};
+
+struct SimpleGossipPage
+{
+    uint32 FirstPart = 0;
+    uint32 PartCount = 0;
+    bool Valid = true;                  // False when a part was missing, such pages are never sent
+    bool Encoded = true;                // All items have pre-encoded fragments, so the packet is built by SimpleGossip itself
+    uint32 DependsOn = SIMPLEGOSSIP_STATE_NONE;     // SimpleGossipState flags of every condition on the page
+};
+
+// The items a player saw on the last page rendered for them, valid while the page's states keep their versions
+struct SimpleGossipRenderCache
+{
+    uint32 Page = SIMPLEGOSSIP_NO_PAGE;
+    uint32 Generation = 0;
+    SimpleGossipStateVersions Versions;
+    std::vector<uint32> Items;
+};
+
+constexpr uint8 SIMPLEGOSSIP_HISTORY_SIZE = 8;
+
+// What one player is looking at, from StartGossip until the gossip is closed
+struct SimpleGossipSession
+{
+    struct Visit
+    {
+        uint32 Page;
+        uint32 TextId;
+    };
+
+    // The page of a generator list sent in the open menu, its items and page links are all that can be selected
+    struct GeneratorPage
+    {
+        uint32 OptionId;
+        uint32 Page;
+        uint32 ItemCount;
+        bool HasPrevious;
+        bool HasNext;
+        bool HasBack;
+    };
+
+    ObjectGuid Sender;
+    Visit Current = { SIMPLEGOSSIP_NO_PAGE, 0 };
+    Visit History[SIMPLEGOSSIP_HISTORY_SIZE] = { };
+    uint8 HistoryStart = 0;             // Ring buffer, the oldest visit is dropped once it is full
+    uint8 HistoryCount = 0;
+    uint32 AsyncTicket = 0;             // Async option work the session waits for, 0 for none
+    std::vector<uint64> Shown;          // One bit per option slot sent in the menu the player has open
+    std::vector<GeneratorPage> GeneratorPages;
+
+    void Reset(ObjectGuid sender)
+    {
+        Sender = sender;
+        AsyncTicket = 0;
+        Current = { SIMPLEGOSSIP_NO_PAGE, 0 };
+        HistoryStart = 0;
+        HistoryCount = 0;
+        ClearShown();
+    }
+
+    // Keeps the words, a pooled session doesn't allocate again for the next menu
+    void ClearShown()
+    {
+        std::fill(Shown.begin(), Shown.end(), 0);
+        GeneratorPages.clear();
+    }
+
+    void MarkShown(uint32 optionId)
+    {
+        uint32 slot = optionId & SimpleGossipSlotMap<SimpleGossipOption*>::INDEX_MASK;
+        if (slot / 64 >= Shown.size())
+            Shown.resize(slot / 64 + 1, 0);
+        Shown[slot / 64] |= uint64(1) << (slot % 64);
+    }
+
+    void ForgetShown(uint32 optionId)
+    {
+        uint32 slot = optionId & SimpleGossipSlotMap<SimpleGossipOption*>::INDEX_MASK;
+        if (slot / 64 < Shown.size())
+            Shown[slot / 64] &= ~(uint64(1) << (slot % 64));
+        GeneratorPages.erase(std::remove_if(GeneratorPages.begin(), GeneratorPages.end(), [optionId](GeneratorPage const& page) { return page.OptionId == optionId; }), GeneratorPages.end());
+    }
+
+    void MarkGeneratorPage(GeneratorPage const& page)
+    {
+        MarkShown(page.OptionId);
+        GeneratorPages.push_back(page);
+    }
+
+    // Whether page << 16 | index of the generator's items was among what the generator sent
+    bool WasGeneratorItemShown(uint32 optionId, uint32 page, uint32 index) const
+    {
+        for (GeneratorPage const& shown : GeneratorPages)
+        {
+            if (shown.OptionId != optionId)
+                continue;
+            if (index == SimpleGossipOptionGenerator::ACTION_SHOW_PAGE)
+                return (shown.HasPrevious && page + 1 == shown.Page) || (shown.HasNext && page == shown.Page + 1);
+            if (index == SimpleGossipOptionGenerator::ACTION_BACK)
+                return shown.HasBack;
+            return page == shown.Page && index < shown.ItemCount;
+        }
+        return false;
+    }
+
+    bool WasShown(uint32 optionId) const
+    {
+        uint32 slot = optionId & SimpleGossipSlotMap<SimpleGossipOption*>::INDEX_MASK;
+        return slot / 64 < Shown.size() && (Shown[slot / 64] >> (slot % 64)) & 1;
+    }
+
+    void Push(Visit visit)
+    {
+        if (HistoryCount == SIMPLEGOSSIP_HISTORY_SIZE)
+        {
+            HistoryStart = (HistoryStart + 1) % SIMPLEGOSSIP_HISTORY_SIZE;
+            --HistoryCount;
+        }
+        History[(HistoryStart + HistoryCount++) % SIMPLEGOSSIP_HISTORY_SIZE] = visit;
+    }
+
+    bool Pop(Visit& visit)
+    {
+        if (HistoryCount == 0)
+            return false;
+        visit = History[(HistoryStart + --HistoryCount) % SIMPLEGOSSIP_HISTORY_SIZE];
+        return true;
+    }
+};
+
+struct SimpleGossipPendingAsync
+{
+    QueryCallback Callback;
+    ObjectGuid Player;
+    uint32 Ticket = 0;
+    uint32 OptionId = 0;
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 // An easy way to set up coded gossip menus.
 // Each gossip contains a set of parts and options to use.
 // A single menu page can have multiple parts which each have their own options within them.
+// The gossip owns all of them: parts from AddPart and options from NewOption live in its
+// arena, options added by pointer are adopted. Everything is freed by Clear or on destruction.
+// Once set up, Finalize compiles the menus into page tables. Changing the graph through the
+// gossip drops them again, anything else changed on parts or options needs a new Finalize.
 ////////////////////////////////////////////////////////////////////////////////////////////
 class SimpleGossip
 {
+	friend class SimpleGossipPart;
+public:
+	typedef SimpleGossipSlotMap<SimpleGossipPart*> PartMap;
+	typedef SimpleGossipSlotMap<SimpleGossipOption*> OptionMap;
 protected:
-	uint32 NextPartId = 1;
-	uint32 NextOptionId = 1;
-	std::unordered_map<uint32, SimpleGossipPart*> Parts;
-	std::unordered_map<uint32, SimpleGossipOption*> Options;
+	// Part and option ids are slot map ids, an id of something removed never resolves again
+	PartMap Parts;
+	OptionMap Options;
+
+	// Option id -> parts listing it, once per listing, so removing options only visits the parts holding them
+	std::unordered_map<uint32, std::vector<uint32>> OptionParts;
+	void IndexOption(uint32 optionId, uint32 partId);
+	void UnindexOption(uint32 optionId, uint32 partId);
+	size_t RemoveOptions(SimpleGossipIdSpan optionIds, bool deleteOptions);
+
+	SimpleGossipArena Arena;
+	std::vector<std::unique_ptr<SimpleGossipPart>> AdoptedParts;
+	std::vector<std::unique_ptr<SimpleGossipOption>> AdoptedOptions;
+
+	bool Finalized = false;
+	uint32 StartingPage = SIMPLEGOSSIP_NO_PAGE;
+	std::vector<SimpleGossipPage> Pages;
+	std::vector<SimpleGossipPagePart> PageParts;
+	std::vector<SimpleGossipPageItem> PageItems;
+	std::map<std::vector<uint32>, uint32> PageIndex;   // part list -> page, only used while finalizing
+	uint32 CompilePage(SimpleGossipIdSpan parts);
+	std::vector<uint8> PageBytes[TOTAL_LOCALES];
+	void EncodeFragments(SimpleGossipPageItem& item);
+	void RenderPage(Player* player, SimpleGossipSession* session, uint32 page);
+	void SendEncodedPage(Player* player, SimpleGossipSession* session, ObjectGuid sender, uint32 textId, uint32 page);
+
+	uint32 Generation = 0;              // Bumped by every Finalize, so cached page indexes of older tables never match
+	std::unordered_map<ObjectGuid, SimpleGossipRenderCache> RenderCache;
+	std::vector<uint32> UncachedItems;
+	std::vector<uint32> const& GetVisibleItems(Player* player, uint32 page);
+	void CollectVisibleItems(Player* player, SimpleGossipPage const& page, std::vector<uint32>& items);
+	bool SendPage(Player* player, ObjectGuid sender, uint32 textId, uint32 page);
+
+	// Sessions are pooled, a released one goes back to FreeSessions for the next StartGossip
+	std::unordered_map<ObjectGuid, SimpleGossipSession*> Sessions;
+	std::deque<SimpleGossipSession> SessionStorage;
+	std::vector<SimpleGossipSession*> FreeSessions;
+	SimpleGossipSession* StartSession(Player* player, ObjectGuid sender);
+	bool WasShown(Player* player, uint32 optionId);
+
+	std::vector<SimpleGossipPendingAsync> PendingAsync;
+	uint32 NextAsyncTicket = 0;
+	void ResumeAsync(SimpleGossipPendingAsync const& done);
+
 public:
+	std::string Name;                   // Registry name, only used for reporting
 	std::vector<uint32> StartingPartIds;
     uint32 StartingTextId = 2; // The "Hello <name>, how can I help you?" text an NPC has above their options, stored in db
 
-	SimpleGossip() = default;
+#ifdef SIMPLEGOSSIP_PROFILER
+	SimpleGossipProfile Profile;
+#endif
+
+	SimpleGossip();
 	~SimpleGossip();
+	SimpleGossip(SimpleGossip const&) = delete;
+	SimpleGossip& operator=(SimpleGossip const&) = delete;
 
     bool StartGossip(Player* player, ObjectGuid sender);
     bool StartGossip(Player* player, Creature* sender);
-    bool ShowParts(Player* player, ObjectGuid sender, std::vector<uint32> parts);
-    bool ShowParts(Player* player, Creature* sender, std::vector<uint32> parts);
-    bool ShowParts(Player* player, ObjectGuid sender, uint32 textId, std::vector<uint32> parts);
-    bool ShowParts(Player* player, Creature* sender, uint32 textId, std::vector<uint32> parts);
-    bool ShowParts(Player* player, uint32 textId, std::vector<uint32> parts);
-    bool ShowParts(Player* player, std::vector<uint32> parts);
+    bool ShowParts(Player* player, ObjectGuid sender, SimpleGossipIdSpan parts);
+    bool ShowParts(Player* player, Creature* sender, SimpleGossipIdSpan parts);
+    bool ShowParts(Player* player, ObjectGuid sender, uint32 textId, SimpleGossipIdSpan parts);
+    bool ShowParts(Player* player, Creature* sender, uint32 textId, SimpleGossipIdSpan parts);
+    bool ShowParts(Player* player, uint32 textId, SimpleGossipIdSpan parts);
+    bool ShowParts(Player* player, SimpleGossipIdSpan parts);
     bool ShowStartingParts(Player* player);
-
+    bool ShowPage(Player* player, ObjectGuid sender, uint32 textId, uint32 page);
+    bool ShowPage(Player* player, uint32 textId, uint32 page);
+    bool ShowCurrentPage(Player* player);
+    bool ShowPreviousPage(Player* player);
+
+	SimpleGossipSession* GetSession(Player* player);
+	void EndSession(ObjectGuid guid);
+	// The session's sender, or the one of the player's current gossip menu without a session
+	ObjectGuid GetSender(Player* player);
+	// Forgets what the player was shown before, a session is started for menus sent without StartGossip
+	SimpleGossipSession* BeginRender(Player* player, ObjectGuid sender);
+	// Options call this for every item they send, only those can be selected afterwards
+	void MarkShown(Player* player, uint32 optionId);
+	// Generators call this for the page they send instead, only its items and links can be selected afterwards
+	void MarkGeneratorPage(Player* player, SimpleGossipSession::GeneratorPage const& page);
+
+	void Finalize();
+	void Invalidate() { Finalized = false; }
+	void ForgetPlayer(ObjectGuid guid) { RenderCache.erase(guid); EndSession(guid); }
+	bool IsFinalized() const { return Finalized; }
+
+	// Keeps the option's work until it completes, see SimpleGossipOptionAsync
+	void AddPendingAsync(Player* player, SimpleGossipOptionAsync* option, QueryCallback&& callback);
+	// Runs the completed async work, true while some is still pending
+	bool ProcessAsync();
+
+	// Options that were not in the player's last menu are refused before any condition or callback runs
 	bool SelectGossipOption(Player* player, uint32 action);
+	// Items of generator options use their generator as sender, everything else GOSSIP_SENDER_MAIN
+	bool SelectGossipOption(Player* player, uint32 sender, uint32 action);
 	bool CloseGossip(Player* player);
 
+	// Allocates an option in the gossip's arena and adds it
+	template<class T, class... Args>
+	T* NewOption(Args&&... args)
+	{
+		T* option = Arena.New<T>(std::forward<Args>(args)...);
+		option->NextParts = SimpleGossipIdList(&Arena);
+		AddOption(option);
+		return option;
+	}
+
 	SimpleGossipPart* AddPart();
 	void AddPart(SimpleGossipPart* part);
 	bool RemovePart(uint32 partId);
@@ -182,19 +560,19 @@ public:
 	void AddOption(SimpleGossipOption* option);
 	bool RemoveOption(uint32 optionId);
 	bool RemoveAndDeleteOption(uint32 optionId);
+	// Batched removal, every affected part is rewritten once. Returns how many options were removed.
+	size_t RemoveOptions(SimpleGossipIdSpan optionIds);
+	size_t RemoveAndDeleteOptions(SimpleGossipIdSpan optionIds);
 	bool Clear();
 	bool ClearAndDelete();
 
 	SimpleGossipPart* GetPartById(uint32 partId);
-	SimpleGossipOption* GetOptionById(uint32 partId);
-
-	std::unordered_map<uint32, SimpleGossipPart*> GetParts() { return Parts; }
-	uint32 GetNextPartId() { return NextPartId; }
-	void IncremenetNextPartId() { NextPartId += 1; }
+	SimpleGossipOption* GetOptionById(uint32 optionId);
+	// Ids of the parts listing the option, empty when none does
+	SimpleGossipIdSpan GetPartsOfOption(uint32 optionId) const;
 
-	std::unordered_map<uint32, SimpleGossipOption*> GetOptions() { return Options; }
-	uint32 GetNextOptionId() { return NextOptionId; }
-	void IncremenetNextOptionId() { NextOptionId += 1; }
+	PartMap const& GetParts() const { return Parts; }
+	OptionMap const& GetOptions() const { return Options; }
 };
 
 #endif
@@ -0,0 +1,235 @@
+// This code is licensed under MIT license
+
+#ifndef _SIMPLEGOSSIPARENA_H
+#define _SIMPLEGOSSIPARENA_H
+
+#include "Define.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Arena owning everything a SimpleGossip allocates.
+// Allocations are carved out of large blocks. Memory given back with Deallocate or Delete
+// goes to a free list of its size class and is reused by the next allocation of that size,
+// so options and parts edited at runtime don't grow the arena. Release runs the destructors
+// of every object still alive, newest first, then frees all blocks at once.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SimpleGossipArena
+{
+public:
+    explicit SimpleGossipArena(size_t blockSize = 4096) : BlockSize(blockSize) { }
+    ~SimpleGossipArena() { Release(); }
+
+    SimpleGossipArena(SimpleGossipArena const&) = delete;
+    SimpleGossipArena& operator=(SimpleGossipArena const&) = delete;
+
+    void* Allocate(size_t size, size_t alignment)
+    {
+        if (alignment <= GRANULE)
+        {
+            size = GetSizeClass(size);
+            auto itr = FreeLists.find(size);
+            if (itr != FreeLists.end() && itr->second)
+            {
+                FreeSlot* slot = itr->second;
+                itr->second = slot->Next;
+                BytesFree -= size;
+                return slot;
+            }
+            alignment = GRANULE;
+        }
+
+        if (!Blocks.empty())
+        {
+            Block& block = Blocks.back();
+            size_t offset = (block.Used + alignment - 1) & ~(alignment - 1);
+            if (offset + size <= block.Size)
+            {
+                block.Used = offset + size;
+                return block.Data + offset;
+            }
+        }
+
+        // Oversized requests get a block of their own
+        size_t blockSize = std::max(BlockSize, size + alignment);
+        Blocks.push_back({ static_cast<char*>(::operator new(blockSize)), blockSize, 0 });
+        Block& block = Blocks.back();
+        size_t offset = (reinterpret_cast<uintptr_t>(block.Data) + alignment - 1) / alignment * alignment - reinterpret_cast<uintptr_t>(block.Data);
+        block.Used = offset + size;
+        BytesReserved += blockSize;
+        return block.Data + offset;
+    }
+
+    // Over aligned memory isn't recycled, it stays unused until Release
+    void Deallocate(void* pointer, size_t size, size_t alignment)
+    {
+        if (!pointer || alignment > GRANULE)
+            return;
+
+        size = GetSizeClass(size);
+        FreeSlot*& head = FreeLists[size];
+        head = new (pointer) FreeSlot{ head };
+        BytesFree += size;
+    }
+
+    template<class T, class... Args>
+    T* New(Args&&... args)
+    {
+        static_assert(alignof(T) <= GRANULE, "arena objects are placed behind their header");
+        ObjectHeader* header = static_cast<ObjectHeader*>(Allocate(HEADER_SIZE + sizeof(T), GRANULE));
+        T* object = new (reinterpret_cast<char*>(header) + HEADER_SIZE) T(std::forward<Args>(args)...);
+        header->Destroy = [](void* o) { static_cast<T*>(o)->~T(); };
+        header->Size = HEADER_SIZE + sizeof(T);
+        header->Previous = nullptr;
+        header->Next = Objects;
+        if (Objects)
+            Objects->Previous = header;
+        Objects = header;
+        return object;
+    }
+
+    // Destroys an object made with New and recycles its memory, polymorphic objects are passed as dynamic_cast<void*>
+    void Delete(void* object)
+    {
+        if (!object)
+            return;
+
+        ObjectHeader* header = reinterpret_cast<ObjectHeader*>(static_cast<char*>(object) - HEADER_SIZE);
+        if (header->Previous)
+            header->Previous->Next = header->Next;
+        else
+            Objects = header->Next;
+        if (header->Next)
+            header->Next->Previous = header->Previous;
+
+        header->Destroy(object);
+        Deallocate(header, header->Size, GRANULE);
+    }
+
+    bool Owns(void const* pointer) const
+    {
+        char const* p = static_cast<char const*>(pointer);
+        for (Block const& block : Blocks)
+            if (p >= block.Data && p < block.Data + block.Size)
+                return true;
+        return false;
+    }
+
+    void Release()
+    {
+        for (ObjectHeader* header = Objects; header; header = header->Next)
+            header->Destroy(reinterpret_cast<char*>(header) + HEADER_SIZE);
+        Objects = nullptr;
+
+        for (Block const& block : Blocks)
+            ::operator delete(block.Data);
+        Blocks.clear();
+        FreeLists.clear();
+        BytesReserved = 0;
+        BytesFree = 0;
+    }
+
+    size_t GetBytesReserved() const { return BytesReserved; }
+    // Given back and waiting in the free lists
+    size_t GetBytesFree() const { return BytesFree; }
+
+private:
+    static constexpr size_t GRANULE = alignof(std::max_align_t);
+
+    struct Block
+    {
+        char* Data;
+        size_t Size;
+        size_t Used;
+    };
+
+    struct FreeSlot
+    {
+        FreeSlot* Next;
+    };
+
+    // In front of every object made with New, links the live objects for Release and Delete
+    struct ObjectHeader
+    {
+        void (*Destroy)(void* object);
+        size_t Size;
+        ObjectHeader* Previous;
+        ObjectHeader* Next;
+    };
+
+    static constexpr size_t HEADER_SIZE = (sizeof(ObjectHeader) + GRANULE - 1) & ~(GRANULE - 1);
+
+    static size_t GetSizeClass(size_t size) { return (std::max(size, sizeof(FreeSlot)) + GRANULE - 1) & ~(GRANULE - 1); }
+
+    size_t BlockSize;
+    size_t BytesReserved = 0;
+    size_t BytesFree = 0;
+    std::vector<Block> Blocks;
+    std::unordered_map<size_t, FreeSlot*> FreeLists;
+    ObjectHeader* Objects = nullptr;
+};
+
+// Standard allocator on top of a SimpleGossipArena, without an arena it falls back to the heap
+template<class T>
+class SimpleGossipArenaAllocator
+{
+public:
+    typedef T value_type;
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    SimpleGossipArenaAllocator(SimpleGossipArena* arena = nullptr) noexcept : Arena(arena) { }
+    template<class U>
+    SimpleGossipArenaAllocator(SimpleGossipArenaAllocator<U> const& other) noexcept : Arena(other.Arena) { }
+
+    T* allocate(size_t count)
+    {
+        if (!Arena)
+            return std::allocator<T>().allocate(count);
+        return static_cast<T*>(Arena->Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, size_t count)
+    {
+        if (!Arena)
+            std::allocator<T>().deallocate(pointer, count);
+        else
+            Arena->Deallocate(pointer, count * sizeof(T), alignof(T));
+    }
+
+    template<class U>
+    bool operator==(SimpleGossipArenaAllocator<U> const& other) const { return Arena == other.Arena; }
+    template<class U>
+    bool operator!=(SimpleGossipArenaAllocator<U> const& other) const { return Arena != other.Arena; }
+
+    SimpleGossipArena* Arena;
+};
+
+typedef std::vector<uint32, SimpleGossipArenaAllocator<uint32>> SimpleGossipIdList;
+
+// Non owning view of part or option ids, so id lists can be passed around without copying them
+struct SimpleGossipIdSpan
+{
+    uint32 const* Data = nullptr;
+    size_t Count = 0;
+
+    SimpleGossipIdSpan() = default;
+    SimpleGossipIdSpan(uint32 const* data, size_t count) : Data(data), Count(count) { }
+    template<class Container>
+    SimpleGossipIdSpan(Container const& ids) : Data(ids.data()), Count(ids.size()) { }
+
+    uint32 const* begin() const { return Data; }
+    uint32 const* end() const { return Data + Count; }
+    size_t size() const { return Count; }
+    bool empty() const { return !Count; }
+};
+
+#endif
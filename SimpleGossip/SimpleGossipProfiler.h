@@ -0,0 +1,73 @@
+// This code is licensed under MIT license
+
+#ifndef _SIMPLEGOSSIPPROFILER_H
+#define _SIMPLEGOSSIPPROFILER_H
+
+#include "Define.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Optional counters for SimpleGossip, compiled in only when SIMPLEGOSSIP_PROFILER is defined.
+// Gossips, parts and options each carry their own SimpleGossipProfile, so counting is a
+// field update without lookups. Without the define the macros below expand to the plain
+// expressions and nothing is stored. `.simplegossip profile show [count]` lists the top entries.
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef SIMPLEGOSSIP_PROFILER
+
+#include <chrono>
+
+constexpr uint8 SIMPLEGOSSIP_PROFILE_BUCKETS = 16;     // Select latency, bucket n holds up to 2^n microseconds
+
+struct SimpleGossipProfile
+{
+    uint64 Renders = 0;
+    uint64 CacheHits = 0;               // Gossips only, page renders served from the render cache
+    uint64 CacheMisses = 0;
+    uint64 ConditionCalls = 0;
+    uint64 ConditionNanos = 0;
+    uint64 Selects = 0;
+    uint64 SelectNanos = 0;
+    uint32 SelectHistogram[SIMPLEGOSSIP_PROFILE_BUCKETS] = { };
+
+    template<class F>
+    bool Condition(F&& condition)
+    {
+        auto start = std::chrono::steady_clock::now();
+        bool result = condition();
+        ConditionNanos += uint64(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        ++ConditionCalls;
+        return result;
+    }
+
+    template<class F>
+    bool Select(F&& select)
+    {
+        auto start = std::chrono::steady_clock::now();
+        bool result = select();
+        uint64 nanos = uint64(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        SelectNanos += nanos;
+        ++Selects;
+
+        uint8 bucket = 0;
+        for (uint64 micros = nanos / 1000; micros > 1 && bucket < SIMPLEGOSSIP_PROFILE_BUCKETS - 1; micros >>= 1)
+            ++bucket;
+        ++SelectHistogram[bucket];
+        return result;
+    }
+
+    void Reset() { *this = SimpleGossipProfile(); }
+};
+
+#define SIMPLEGOSSIP_PROFILE_COUNT(owner, field) (++(owner)->Profile.field)
+#define SIMPLEGOSSIP_PROFILE_CONDITION(owner, ...) ((owner)->Profile.Condition([&]() -> bool { return __VA_ARGS__; }))
+#define SIMPLEGOSSIP_PROFILE_SELECT(owner, ...) ((owner)->Profile.Select([&]() -> bool { return __VA_ARGS__; }))
+
+#else
+
+#define SIMPLEGOSSIP_PROFILE_COUNT(owner, field) ((void)0)
+#define SIMPLEGOSSIP_PROFILE_CONDITION(owner, ...) (__VA_ARGS__)
+#define SIMPLEGOSSIP_PROFILE_SELECT(owner, ...) (__VA_ARGS__)
+
+#endif
+
+#endif
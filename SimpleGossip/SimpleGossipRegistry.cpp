@@ -0,0 +1,656 @@
+// This code is licensed under MIT license
+
+#include "SimpleGossipRegistry.h"
+#include "Chat.h"
+#include "ChatCommand.h"
+#include "Config.h"
+#include "Creature.h"
+#include "CreatureAI.h"
+#include "Log.h"
+#include "RBAC.h"
+#include "ScriptMgr.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <vector>
+
+using namespace Trinity::ChatCommands;
+
+namespace
+{
+    struct OptionDefinition
+    {
+        uint32 Line = 0;
+        std::string Part;
+        GossipOptionIcon Icon = GOSSIP_ICON_CHAT;
+        std::string Text;
+        bool Popup = false;
+        std::string PopupText;
+        uint32 PopupCopper = 0;
+        std::vector<std::string> NextParts;
+        uint32 NextTextId = 0;
+        bool Close = false;
+        bool Stay = false;
+        bool Back = false;
+        std::string Action;
+        std::string Condition;
+    };
+
+    struct LocaleTextDefinition
+    {
+        LocaleConstant Locale;
+        std::string Text;
+        std::string Localized;
+    };
+
+    struct GossipDefinition
+    {
+        std::string Name;
+        uint32 TextId = 2;
+        std::vector<uint32> Entries;
+        std::vector<std::string> Parts;
+        std::vector<OptionDefinition> Options;
+        std::vector<std::string> StartingParts;
+    };
+
+    // Whitespace separated words, "quoted text" is one token without its quotes
+    bool Tokenize(std::string const& line, std::vector<std::string>& tokens)
+    {
+        tokens.clear();
+        size_t i = 0;
+        while (i < line.size())
+        {
+            if (isspace(static_cast<unsigned char>(line[i])))
+            {
+                ++i;
+                continue;
+            }
+            if (line[i] == '#')
+                break;
+
+            if (line[i] == '"')
+            {
+                size_t end = line.find('"', i + 1);
+                if (end == std::string::npos)
+                    return false;
+                tokens.push_back(line.substr(i + 1, end - i - 1));
+                i = end + 1;
+                continue;
+            }
+
+            size_t end = i;
+            while (end < line.size() && !isspace(static_cast<unsigned char>(line[end])))
+                ++end;
+            tokens.push_back(line.substr(i, end - i));
+            i = end;
+        }
+        return true;
+    }
+
+    bool ParseUInt32(std::string const& token, uint32& value)
+    {
+        if (token.empty() || token.find_first_not_of("0123456789") != std::string::npos || token.size() > 10)
+            return false;
+        uint64 parsed = std::stoull(token);
+        if (parsed > 0xFFFFFFFF)
+            return false;
+        value = uint32(parsed);
+        return true;
+    }
+
+    void SplitList(std::string const& token, std::vector<std::string>& list)
+    {
+        size_t start = 0;
+        while (start <= token.size())
+        {
+            size_t end = token.find(',', start);
+            if (end == std::string::npos)
+                end = token.size();
+            if (end > start)
+                list.push_back(token.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+
+    // option <part> <icon> "<text>" [popup "<text>" <copper>] [goto <part>[,<part>]] [text <id>] [close] [stay] [back] [action <name>] [if <condition>]
+    char const* ParseOption(std::vector<std::string> const& tokens, OptionDefinition& option)
+    {
+        uint32 icon;
+        if (tokens.size() < 4 || !ParseUInt32(tokens[2], icon))
+            return "expected option <part> <icon> \"<text>\"";
+
+        option.Part = tokens[1];
+        option.Icon = GossipOptionIcon(icon);
+        option.Text = tokens[3];
+
+        for (size_t i = 4; i < tokens.size(); ++i)
+        {
+            std::string const& key = tokens[i];
+            if (key == "popup")
+            {
+                if (i + 2 >= tokens.size() || !ParseUInt32(tokens[i + 2], option.PopupCopper))
+                    return "expected popup \"<text>\" <copper>";
+                option.Popup = true;
+                option.PopupText = tokens[i + 1];
+                i += 2;
+            }
+            else if (key == "goto")
+            {
+                if (++i >= tokens.size())
+                    return "expected goto <part>[,<part>]";
+                SplitList(tokens[i], option.NextParts);
+            }
+            else if (key == "text")
+            {
+                if (++i >= tokens.size() || !ParseUInt32(tokens[i], option.NextTextId))
+                    return "expected text <id>";
+            }
+            else if (key == "close")
+                option.Close = true;
+            else if (key == "stay")
+                option.Stay = true;
+            else if (key == "back")
+                option.Back = true;
+            else if (key == "action")
+            {
+                if (++i >= tokens.size())
+                    return "expected action <name>";
+                option.Action = tokens[i];
+            }
+            else if (key == "if")
+            {
+                if (++i >= tokens.size())
+                    return "expected if <condition>";
+                option.Condition = tokens[i];
+            }
+            else
+                return "unknown option keyword";
+        }
+        return nullptr;
+    }
+
+    void LogLineError(std::string const& path, uint32 line, char const* error)
+    {
+        TC_LOG_ERROR("server.loading", "SimpleGossipRegistry: %s:%u: %s, line skipped.", path.c_str(), line, error);
+    }
+}
+
+// Destroying a gossip unregisters it from the state tracker, so the tracker has to be built first to outlive every gossip at exit
+SimpleGossipRegistry::SimpleGossipRegistry()
+{
+    (void)sSimpleGossipState;
+}
+
+SimpleGossipRegistry* SimpleGossipRegistry::instance()
+{
+    static SimpleGossipRegistry instance;
+    return &instance;
+}
+
+SimpleGossip* SimpleGossipRegistry::Register(std::string const& name)
+{
+    Entry& entry = Gossips[name];
+    if (!entry.Gossip)
+    {
+        entry.Gossip = std::make_unique<SimpleGossip>();
+        entry.Gossip->Name = name;
+    }
+    entry.FromFile = false;
+    return entry.Gossip.get();
+}
+
+void SimpleGossipRegistry::BindEntry(uint32 entry, std::string const& name)
+{
+    SimpleGossip* gossip = GetByName(name);
+    Entries[entry] = gossip ? gossip : Register(name);
+    FileEntries.erase(entry);
+}
+
+SimpleGossip* SimpleGossipRegistry::GetByName(std::string const& name) const
+{
+    auto itr = Gossips.find(name);
+    return itr != Gossips.end() ? itr->second.Gossip.get() : nullptr;
+}
+
+SimpleGossip* SimpleGossipRegistry::GetByEntry(uint32 entry) const
+{
+    auto itr = Entries.find(entry);
+    return itr != Entries.end() ? itr->second : nullptr;
+}
+
+SimpleGossip* SimpleGossipRegistry::Get(Creature const* creature) const
+{
+    if (SimpleGossip* gossip = GetByEntry(creature->GetEntry()))
+        return gossip;
+    return GetByName(creature->GetScriptName());
+}
+
+void SimpleGossipRegistry::RegisterAction(std::string const& name, SGBaseCallback action)
+{
+    Actions[name] = action;
+}
+
+void SimpleGossipRegistry::RegisterCondition(std::string const& name, SGConditionallyShow condition, uint32 dependsOn)
+{
+    Conditions[name] = { condition, dependsOn };
+}
+
+// The whole file is parsed before any gossip is rebuilt, bad lines are logged and skipped.
+bool SimpleGossipRegistry::LoadFromFile(std::string const& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        TC_LOG_ERROR("server.loading", "SimpleGossipRegistry: could not open gossip data file %s.", path.c_str());
+        return false;
+    }
+
+    std::vector<GossipDefinition> definitions;
+    std::vector<LocaleTextDefinition> localeTexts;
+    std::vector<std::string> tokens;
+    std::string line;
+    uint32 lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        if (!Tokenize(line, tokens))
+        {
+            LogLineError(path, lineNumber, "unterminated quote");
+            continue;
+        }
+        if (tokens.empty())
+            continue;
+
+        std::string const& keyword = tokens[0];
+        if (keyword == "gossip")
+        {
+            GossipDefinition definition;
+            if (tokens.size() < 2 || tokens.size() > 3 || (tokens.size() == 3 && !ParseUInt32(tokens[2], definition.TextId)))
+            {
+                LogLineError(path, lineNumber, "expected gossip <name> [<text id>]");
+                continue;
+            }
+            definition.Name = tokens[1];
+            definitions.push_back(std::move(definition));
+            continue;
+        }
+        // Translations are shared by every gossip, so they may come before the first one
+        if (keyword == "localize")
+        {
+            LocaleConstant locale = tokens.size() == 4 ? GetLocaleByName(tokens[1]) : LOCALE_enUS;
+            if (locale == LOCALE_enUS)
+                LogLineError(path, lineNumber, "expected localize <locale> \"<text>\" \"<translation>\" with a locale other than enUS");
+            else
+                localeTexts.push_back({ locale, tokens[2], tokens[3] });
+            continue;
+        }
+
+        if (definitions.empty())
+        {
+            LogLineError(path, lineNumber, "no gossip started yet");
+            continue;
+        }
+
+        GossipDefinition& definition = definitions.back();
+        if (keyword == "entry")
+        {
+            for (size_t i = 1; i < tokens.size(); ++i)
+            {
+                uint32 entry;
+                if (ParseUInt32(tokens[i], entry))
+                    definition.Entries.push_back(entry);
+                else
+                    LogLineError(path, lineNumber, "bad creature entry");
+            }
+        }
+        else if (keyword == "part" && tokens.size() == 2)
+            definition.Parts.push_back(tokens[1]);
+        else if (keyword == "start" && tokens.size() >= 2)
+            definition.StartingParts.insert(definition.StartingParts.end(), tokens.begin() + 1, tokens.end());
+        else if (keyword == "option")
+        {
+            OptionDefinition option;
+            option.Line = lineNumber;
+            if (char const* error = ParseOption(tokens, option))
+                LogLineError(path, lineNumber, error);
+            else
+                definition.Options.push_back(std::move(option));
+        }
+        else
+            LogLineError(path, lineNumber, "unknown keyword");
+    }
+
+    // Before the gossips are rebuilt, so finalizing them encodes the translations
+    for (LocaleTextDefinition const& localeText : localeTexts)
+        sSimpleGossipStrings->SetLocaleText(localeText.Text, localeText.Locale, localeText.Localized);
+
+    // Entries bound by the previous load are rebound below, entries bound from code stay
+    for (uint32 entry : FileEntries)
+        Entries.erase(entry);
+    FileEntries.clear();
+
+    std::unordered_set<std::string> loaded;
+    for (GossipDefinition const& definition : definitions)
+    {
+        Entry& entry = Gossips[definition.Name];
+        if (entry.Gossip && !entry.FromFile)
+        {
+            TC_LOG_ERROR("server.loading", "SimpleGossipRegistry: %s: gossip %s is registered from code, skipped.", path.c_str(), definition.Name.c_str());
+            continue;
+        }
+        if (!loaded.insert(definition.Name).second)
+        {
+            TC_LOG_ERROR("server.loading", "SimpleGossipRegistry: %s: gossip %s is defined twice, the second one is skipped.", path.c_str(), definition.Name.c_str());
+            continue;
+        }
+        if (!entry.Gossip)
+        {
+            entry.Gossip = std::make_unique<SimpleGossip>();
+            entry.Gossip->Name = definition.Name;
+        }
+        entry.FromFile = true;
+
+        SimpleGossip* gossip = entry.Gossip.get();
+        gossip->Clear();
+        gossip->StartingTextId = definition.TextId;
+
+        std::map<std::string, SimpleGossipPart*> parts;
+        for (std::string const& label : definition.Parts)
+            parts[label] = gossip->AddPart();
+
+        for (OptionDefinition const& optionDefinition : definition.Options)
+        {
+            auto part = parts.find(optionDefinition.Part);
+            if (part == parts.end())
+            {
+                LogLineError(path, optionDefinition.Line, "unknown part");
+                continue;
+            }
+
+            SGBaseCallback action = nullptr;
+            if (!optionDefinition.Action.empty())
+            {
+                auto itr = Actions.find(optionDefinition.Action);
+                if (itr == Actions.end())
+                {
+                    LogLineError(path, optionDefinition.Line, "unknown action");
+                    continue;
+                }
+                action = itr->second;
+            }
+
+            Condition const* condition = nullptr;
+            if (!optionDefinition.Condition.empty())
+            {
+                auto itr = Conditions.find(optionDefinition.Condition);
+                if (itr == Conditions.end())
+                {
+                    LogLineError(path, optionDefinition.Line, "unknown condition");
+                    continue;
+                }
+                condition = &itr->second;
+            }
+
+            SimpleGossipIdList nextParts;
+            bool nextPartsFound = true;
+            for (std::string const& label : optionDefinition.NextParts)
+            {
+                auto next = parts.find(label);
+                if (next == parts.end())
+                {
+                    nextPartsFound = false;
+                    break;
+                }
+                nextParts.push_back(next->second->PartId);
+            }
+            if (!nextPartsFound)
+            {
+                LogLineError(path, optionDefinition.Line, "unknown goto part");
+                continue;
+            }
+
+            SimpleGossipOption* option;
+            if (optionDefinition.Popup)
+            {
+                // Paid actions only run once the money was taken
+                bool paid = optionDefinition.PopupCopper != 0;
+                option = gossip->NewOption<SimpleGossipOptionIconTextPopup>(optionDefinition.Icon, optionDefinition.Text, optionDefinition.PopupText, optionDefinition.PopupCopper,
+                    [action, paid](Player* player, bool success, SimpleGossipOptionIconTextPopup* option)
+                    {
+                        if (action && (success || !paid))
+                            action(player, option);
+                    });
+            }
+            else
+            {
+                option = gossip->NewOption<SimpleGossipOptionIconText>(optionDefinition.Icon, optionDefinition.Text,
+                    [action](Player* player, SimpleGossipOptionIconText* option)
+                    {
+                        if (action)
+                            action(player, option);
+                    });
+            }
+
+            option->NextParts.assign(nextParts.begin(), nextParts.end());
+            option->NextTextId = optionDefinition.NextTextId;
+            option->CloseDialogOnSelect = optionDefinition.Close;
+            option->RestartOnSelect = !optionDefinition.Stay && !optionDefinition.Close;
+            option->GoBack = optionDefinition.Back;
+            if (condition)
+            {
+                option->ConditionallyShow = condition->Show;
+                option->ConditionDependsOn = condition->DependsOn;
+            }
+            part->second->AddOption(option);
+        }
+
+        gossip->StartingPartIds.clear();
+        for (std::string const& label : definition.StartingParts)
+        {
+            auto part = parts.find(label);
+            if (part != parts.end())
+                gossip->StartingPartIds.push_back(part->second->PartId);
+            else
+                TC_LOG_ERROR("server.loading", "SimpleGossipRegistry: %s: gossip %s starts with unknown part %s, skipped.", path.c_str(), definition.Name.c_str(), label.c_str());
+        }
+
+        for (uint32 creatureEntry : definition.Entries)
+        {
+            // Bindings made from code win over the file
+            if (Entries.count(creatureEntry))
+                continue;
+            Entries[creatureEntry] = gossip;
+            FileEntries.insert(creatureEntry);
+        }
+
+        gossip->Finalize();
+    }
+
+    for (auto& [name, entry] : Gossips)
+    {
+        if (entry.FromFile && !loaded.count(name))
+        {
+            entry.Gossip->Clear();
+        }
+    }
+
+    TC_LOG_INFO("server.loading", ">> Loaded %u SimpleGossip menus from %s.", uint32(loaded.size()), path.c_str());
+    return true;
+}
+
+// Any creature with this script name shows the SimpleGossip registered for its entry or script name
+class npc_simplegossip : public CreatureScript
+{
+public:
+    npc_simplegossip() : CreatureScript("npc_simplegossip") { }
+
+    struct npc_simplegossipAI : public CreatureAI
+    {
+        npc_simplegossipAI(Creature* creature) : CreatureAI(creature) { }
+
+        bool OnGossipHello(Player* player) override
+        {
+            SimpleGossip* gossip = sSimpleGossipRegistry->Get(me);
+            return gossip && gossip->StartGossip(player, me);
+        }
+
+        bool OnGossipSelect(Player* player, uint32 /*menuId*/, uint32 gossipListId) override
+        {
+            SimpleGossip* gossip = sSimpleGossipRegistry->Get(me);
+            if (!gossip)
+                return false;
+
+            uint32 const sender = player->PlayerTalkClass->GetGossipOptionSender(gossipListId);
+            uint32 const action = player->PlayerTalkClass->GetGossipOptionAction(gossipListId);
+            gossip->SelectGossipOption(player, sender, action);
+            return true;
+        }
+
+        void UpdateAI(uint32 /*diff*/) override
+        {
+            if (!UpdateVictim())
+                return;
+            DoMeleeAttackIfReady();
+        }
+    };
+
+    CreatureAI* GetAI(Creature* creature) const override
+    {
+        return new npc_simplegossipAI(creature);
+    }
+};
+
+class simplegossip_registry_world : public WorldScript
+{
+public:
+    simplegossip_registry_world() : WorldScript("simplegossip_registry_world") { }
+
+    void OnStartup() override
+    {
+        Load();
+    }
+
+    void OnConfigLoad(bool reload) override
+    {
+        if (reload)
+            Load();
+    }
+
+private:
+    static void Load()
+    {
+        std::string path = sConfigMgr->GetStringDefault("SimpleGossip.DataFile", "");
+        if (!path.empty())
+            sSimpleGossipRegistry->LoadFromFile(path);
+    }
+};
+
+class simplegossip_commandscript : public CommandScript
+{
+public:
+    simplegossip_commandscript() : CommandScript("simplegossip_commandscript") { }
+
+    ChatCommandTable GetCommands() const override
+    {
+        static ChatCommandTable simpleGossipProfileCommandTable =
+        {
+            { "show",  HandleSimpleGossipProfileShowCommand,  rbac::RBAC_PERM_COMMAND_DEBUG, Console::Yes },
+            { "reset", HandleSimpleGossipProfileResetCommand, rbac::RBAC_PERM_COMMAND_DEBUG, Console::Yes },
+        };
+        static ChatCommandTable simpleGossipCommandTable =
+        {
+            { "profile", simpleGossipProfileCommandTable },
+        };
+        static ChatCommandTable commandTable =
+        {
+            { "simplegossip", simpleGossipCommandTable },
+        };
+        return commandTable;
+    }
+
+#ifdef SIMPLEGOSSIP_PROFILER
+    // Upper bound in microseconds of the histogram bucket holding the given fraction of selects
+    static uint32 SelectPercentile(SimpleGossipProfile const& profile, float fraction)
+    {
+        uint64 wanted = uint64(profile.Selects * fraction);
+        uint64 seen = 0;
+        for (uint8 bucket = 0; bucket < SIMPLEGOSSIP_PROFILE_BUCKETS; ++bucket)
+        {
+            seen += profile.SelectHistogram[bucket];
+            if (seen > wanted)
+                return 1u << bucket;
+        }
+        return 1u << (SIMPLEGOSSIP_PROFILE_BUCKETS - 1);
+    }
+
+    // Everything profiled, most time spent in conditions and selects first
+    static bool HandleSimpleGossipProfileShowCommand(ChatHandler* handler, Optional<uint32> count)
+    {
+        struct Row
+        {
+            SimpleGossip const* Gossip;
+            char const* Kind;
+            uint32 Id;
+            SimpleGossipProfile const* Profile;
+        };
+
+        std::vector<Row> rows;
+        sSimpleGossipRegistry->ForEachGossip([&](SimpleGossip* gossip)
+        {
+            handler->PSendSysMessage("Gossip %s: " UI64FMTD " renders, " UI64FMTD " cache hits, " UI64FMTD " cache misses.", gossip->Name.c_str(),
+                gossip->Profile.Renders, gossip->Profile.CacheHits, gossip->Profile.CacheMisses);
+            for (SimpleGossipPart const* part : gossip->GetParts())
+                rows.push_back({ gossip, "part", part->PartId, &part->Profile });
+            for (SimpleGossipOption const* option : gossip->GetOptions())
+                rows.push_back({ gossip, "option", option->OptionId, &option->Profile });
+        });
+
+        auto cost = [](Row const& row) { return row.Profile->ConditionNanos + row.Profile->SelectNanos; };
+        std::sort(rows.begin(), rows.end(), [&](Row const& left, Row const& right) { return cost(left) > cost(right); });
+
+        uint32 shown = std::min<uint32>(count.value_or(10), uint32(rows.size()));
+        for (uint32 i = 0; i < shown; ++i)
+        {
+            Row const& row = rows[i];
+            SimpleGossipProfile const& profile = *row.Profile;
+            handler->PSendSysMessage("%s %s %u: " UI64FMTD " renders, " UI64FMTD " conditions in " UI64FMTD " us, " UI64FMTD " selects in " UI64FMTD " us (p50 <= %u us, p99 <= %u us).",
+                row.Gossip->Name.c_str(), row.Kind, row.Id, profile.Renders, profile.ConditionCalls, profile.ConditionNanos / 1000,
+                profile.Selects, profile.SelectNanos / 1000, SelectPercentile(profile, 0.5f), SelectPercentile(profile, 0.99f));
+        }
+        return true;
+    }
+
+    static bool HandleSimpleGossipProfileResetCommand(ChatHandler* handler)
+    {
+        sSimpleGossipRegistry->ForEachGossip([](SimpleGossip* gossip)
+        {
+            gossip->Profile.Reset();
+            for (SimpleGossipPart* part : gossip->GetParts())
+                part->Profile.Reset();
+            for (SimpleGossipOption* option : gossip->GetOptions())
+                option->Profile.Reset();
+        });
+        handler->SendSysMessage("SimpleGossip profiles reset.");
+        return true;
+    }
+#else
+    static bool HandleSimpleGossipProfileShowCommand(ChatHandler* handler, Optional<uint32> /*count*/)
+    {
+        handler->SendSysMessage("SimpleGossip was built without SIMPLEGOSSIP_PROFILER.");
+        return true;
+    }
+
+    static bool HandleSimpleGossipProfileResetCommand(ChatHandler* handler)
+    {
+        handler->SendSysMessage("SimpleGossip was built without SIMPLEGOSSIP_PROFILER.");
+        return true;
+    }
+#endif
+};
+
+void AddSC_SimpleGossipRegistry()
+{
+    new npc_simplegossip();
+    new simplegossip_registry_world();
+    new simplegossip_commandscript();
+}
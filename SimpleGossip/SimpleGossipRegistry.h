@@ -0,0 +1,76 @@
+// This code is licensed under MIT license
+
+#ifndef _SIMPLEGOSSIPREGISTRY_H
+#define _SIMPLEGOSSIPREGISTRY_H
+
+#include "SimpleGossip.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+class Creature;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Shared SimpleGossip definitions, keyed by name and optionally bound to creature entries.
+// A gossip keeps no per spawn state, so every spawn of an entry or script shows the same
+// finalized menu. Mods register theirs by name from code, and menus made only of text and
+// navigation can be defined in the file from SimpleGossip.DataFile, see
+// simplegossip_menus.example.txt. Options in the file call into code through the actions
+// and conditions registered here by name.
+////////////////////////////////////////////////////////////////////////////////////////////
+class TC_GAME_API SimpleGossipRegistry
+{
+public:
+    static SimpleGossipRegistry* instance();
+
+    // Returns the gossip registered under the name, an empty one the first time
+    SimpleGossip* Register(std::string const& name);
+    void BindEntry(uint32 entry, std::string const& name);
+
+    SimpleGossip* GetByName(std::string const& name) const;
+    SimpleGossip* GetByEntry(uint32 entry) const;
+    // The entry binding first, then the creature's script name
+    SimpleGossip* Get(Creature const* creature) const;
+
+    template<class F>
+    void ForEachGossip(F&& f) const
+    {
+        for (auto const& [name, entry] : Gossips)
+            f(entry.Gossip.get());
+    }
+
+    void RegisterAction(std::string const& name, SGBaseCallback action);
+    void RegisterCondition(std::string const& name, SGConditionallyShow condition, uint32 dependsOn = SIMPLEGOSSIP_STATE_UNTRACKED);
+
+    // Rebuilds every gossip of the file. Gossips registered from code are never touched, and
+    // file gossips gone from the file are cleared but stay registered.
+    bool LoadFromFile(std::string const& path);
+
+private:
+    SimpleGossipRegistry();
+
+    struct Entry
+    {
+        std::unique_ptr<SimpleGossip> Gossip;
+        bool FromFile = false;
+    };
+
+    struct Condition
+    {
+        SGConditionallyShow Show;
+        uint32 DependsOn = SIMPLEGOSSIP_STATE_UNTRACKED;
+    };
+
+    std::unordered_map<std::string, Entry> Gossips;
+    std::unordered_map<uint32, SimpleGossip*> Entries;
+    std::unordered_set<uint32> FileEntries;
+    std::unordered_map<std::string, SGBaseCallback> Actions;
+    std::unordered_map<std::string, Condition> Conditions;
+};
+
+#define sSimpleGossipRegistry SimpleGossipRegistry::instance()
+
+void AddSC_SimpleGossipRegistry();
+
+#endif
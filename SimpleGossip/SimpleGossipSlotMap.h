@@ -0,0 +1,118 @@
+// This code is licensed under MIT license
+
+#ifndef _SIMPLEGOSSIPSLOTMAP_H
+#define _SIMPLEGOSSIPSLOTMAP_H
+
+#include "Define.h"
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Generational slot map used for the parts and options of a SimpleGossip.
+// Values are kept packed in one vector so iterating never skips holes, and an id is the
+// slot index plus the generation of that slot, so looking one up is two array reads.
+// Erasing bumps the slot's generation, any id still pointing at it stops resolving.
+////////////////////////////////////////////////////////////////////////////////////////////
+template<class T>
+class SimpleGossipSlotMap
+{
+public:
+    static constexpr uint32 INDEX_BITS = 20;
+    static constexpr uint32 INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr uint32 GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+    typedef typename std::vector<T>::const_iterator const_iterator;
+
+    uint32 Insert(T value)
+    {
+        uint32 slot;
+        if (!FreeSlots.empty())
+        {
+            slot = FreeSlots.back();
+            FreeSlots.pop_back();
+        }
+        else
+        {
+            slot = uint32(Slots.size());
+            Slots.push_back({ 0, 1 });
+        }
+
+        Slots[slot].Value = uint32(Values.size());
+        Values.push_back(std::move(value));
+        ValueSlots.push_back(slot);
+        return MakeId(slot, Slots[slot].Generation);
+    }
+
+    // The last value is moved into the hole, so erasing changes the iteration order
+    bool Erase(uint32 id)
+    {
+        uint32 slot = id & INDEX_MASK;
+        if (!IsLive(id))
+            return false;
+
+        uint32 value = Slots[slot].Value;
+        uint32 last = uint32(Values.size() - 1);
+        if (value != last)
+        {
+            Values[value] = std::move(Values[last]);
+            ValueSlots[value] = ValueSlots[last];
+            Slots[ValueSlots[value]].Value = value;
+        }
+        Values.pop_back();
+        ValueSlots.pop_back();
+
+        Release(slot);
+        return true;
+    }
+
+    T* Find(uint32 id) { return IsLive(id) ? &Values[Slots[id & INDEX_MASK].Value] : nullptr; }
+    T const* Find(uint32 id) const { return IsLive(id) ? &Values[Slots[id & INDEX_MASK].Value] : nullptr; }
+    bool Contains(uint32 id) const { return IsLive(id); }
+
+    void Clear()
+    {
+        for (uint32 slot : ValueSlots)
+            Release(slot);
+        Values.clear();
+        ValueSlots.clear();
+    }
+
+    size_t Size() const { return Values.size(); }
+    bool Empty() const { return Values.empty(); }
+    // Id of the value at a position of the packed storage
+    uint32 GetId(size_t position) const { return MakeId(ValueSlots[position], Slots[ValueSlots[position]].Generation); }
+
+    const_iterator begin() const { return Values.begin(); }
+    const_iterator end() const { return Values.end(); }
+
+private:
+    struct Slot
+    {
+        uint32 Value;           // position in Values while the slot is live
+        uint32 Generation;
+    };
+
+    static uint32 MakeId(uint32 slot, uint32 generation) { return (generation << INDEX_BITS) | slot; }
+
+    bool IsLive(uint32 id) const
+    {
+        uint32 slot = id & INDEX_MASK;
+        return slot < Slots.size() && Slots[slot].Generation == id >> INDEX_BITS;
+    }
+
+    void Release(uint32 slot)
+    {
+        // Generation 0 is never handed out, so 0 is never a valid id
+        Slots[slot].Generation = (Slots[slot].Generation + 1) & GENERATION_MASK;
+        if (!Slots[slot].Generation)
+            Slots[slot].Generation = 1;
+        FreeSlots.push_back(slot);
+    }
+
+    std::vector<T> Values;
+    std::vector<uint32> ValueSlots;     // slot owning each value
+    std::vector<Slot> Slots;
+    std::vector<uint32> FreeSlots;
+};
+
+#endif
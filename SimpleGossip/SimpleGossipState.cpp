@@ -0,0 +1,109 @@
+// This code is licensed under MIT license
+
+#include "SimpleGossipState.h"
+#include "SimpleGossip.h"
+#include "Player.h"
+#include "ScriptMgr.h"
+
+SimpleGossipStateTracker* SimpleGossipStateTracker::instance()
+{
+    static SimpleGossipStateTracker instance;
+    return &instance;
+}
+
+void SimpleGossipStateTracker::Bump(ObjectGuid guid, uint32 states)
+{
+    SimpleGossipStateVersions& versions = GetOrCreate(guid).Versions;
+    for (uint8 i = 0; i < SIMPLEGOSSIP_STATE_COUNT; ++i)
+        if (states & (1 << i))
+            versions.Versions[i] = NextVersion++;
+}
+
+SimpleGossipStateVersions const& SimpleGossipStateTracker::Get(Player* player)
+{
+    SimpleGossipPlayerStates& states = GetOrCreate(player->GetGUID());
+    bool teamsChanged = false;
+    for (uint8 slot = 0; slot < MAX_ARENA_SLOT; ++slot)
+    {
+        uint32 teamId = player->GetArenaTeamId(slot);
+        if (states.ArenaTeamIds[slot] != teamId)
+        {
+            states.ArenaTeamIds[slot] = teamId;
+            teamsChanged = true;
+        }
+    }
+
+    if (teamsChanged)
+        Bump(player->GetGUID(), SIMPLEGOSSIP_STATE_ARENA_TEAM);
+    return states.Versions;
+}
+
+SimpleGossipPlayerStates& SimpleGossipStateTracker::GetOrCreate(ObjectGuid guid)
+{
+    auto itr = Players.find(guid);
+    if (itr != Players.end())
+        return itr->second;
+
+    SimpleGossipPlayerStates& states = Players[guid];
+    for (uint32& version : states.Versions.Versions)
+        version = NextVersion++;
+    return states;
+}
+
+void SimpleGossipStateTracker::Forget(ObjectGuid guid)
+{
+    Players.erase(guid);
+    for (SimpleGossip* gossip : Gossips)
+        gossip->ForgetPlayer(guid);
+}
+
+// Resuming may start new async work on any gossip, which is scheduled again for the next update
+void SimpleGossipStateTracker::Update()
+{
+    if (PendingGossips.empty())
+        return;
+
+    std::vector<SimpleGossip*> gossips(PendingGossips.begin(), PendingGossips.end());
+    PendingGossips.clear();
+    for (SimpleGossip* gossip : gossips)
+        if (gossip->ProcessAsync())
+            PendingGossips.insert(gossip);
+}
+
+class simplegossip_player_state : public PlayerScript
+{
+public:
+    simplegossip_player_state() : PlayerScript("simplegossip_player_state") { }
+
+    void OnMoneyChanged(Player* player, int32& /*amount*/) override
+    {
+        sSimpleGossipState->Bump(player->GetGUID(), SIMPLEGOSSIP_STATE_MONEY);
+    }
+
+    void OnLevelChanged(Player* player, uint8 /*oldLevel*/) override
+    {
+        sSimpleGossipState->Bump(player->GetGUID(), SIMPLEGOSSIP_STATE_LEVEL);
+    }
+
+    void OnLogout(Player* player) override
+    {
+        sSimpleGossipState->Forget(player->GetGUID());
+    }
+};
+
+class simplegossip_world_state : public WorldScript
+{
+public:
+    simplegossip_world_state() : WorldScript("simplegossip_world_state") { }
+
+    void OnUpdate(uint32 /*diff*/) override
+    {
+        sSimpleGossipState->Update();
+    }
+};
+
+void AddSC_SimpleGossipState()
+{
+    new simplegossip_player_state();
+    new simplegossip_world_state();
+}
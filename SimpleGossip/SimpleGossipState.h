@@ -0,0 +1,90 @@
+// This code is licensed under MIT license
+
+#ifndef _SIMPLEGOSSIPSTATE_H
+#define _SIMPLEGOSSIPSTATE_H
+
+#include "ArenaTeam.h"
+#include "Define.h"
+#include "ObjectGuid.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Player;
+class SimpleGossip;
+
+// Player state a condition can depend on, each one has its own version per player
+enum SimpleGossipState : uint32
+{
+    SIMPLEGOSSIP_STATE_NONE         = 0x00,
+    SIMPLEGOSSIP_STATE_ARENA_TEAM   = 0x01,
+    SIMPLEGOSSIP_STATE_QUEUE        = 0x02,
+    SIMPLEGOSSIP_STATE_MONEY        = 0x04,
+    SIMPLEGOSSIP_STATE_LEVEL        = 0x08,
+
+    // Anything without a version, menus depending on it are never cached
+    SIMPLEGOSSIP_STATE_UNTRACKED    = 0x80000000
+};
+
+constexpr uint8 SIMPLEGOSSIP_STATE_COUNT = 4;
+
+struct SimpleGossipStateVersions
+{
+    uint32 Versions[SIMPLEGOSSIP_STATE_COUNT] = { };
+
+    // True when every state in the mask has the same version in both
+    bool Matches(SimpleGossipStateVersions const& other, uint32 states) const
+    {
+        for (uint8 i = 0; i < SIMPLEGOSSIP_STATE_COUNT; ++i)
+            if ((states & (1 << i)) && Versions[i] != other.Versions[i])
+                return false;
+        return true;
+    }
+};
+
+struct SimpleGossipPlayerStates
+{
+    SimpleGossipStateVersions Versions;
+    uint32 ArenaTeamIds[MAX_ARENA_SLOT] = { };     // As of the last Get, the client can leave or disband a team without any hook
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Per player state versions used by the SimpleGossip render cache.
+// Whatever changes a state bumps its version, money, level and logout are hooked by the
+// player script from AddSC_SimpleGossipState, arena team changes are also noticed by Get,
+// everything else is up to the mods using it.
+// It also knows every gossip, so it drives their async option work from the world update.
+// Versions come from one global counter, so a player seen again never reuses old versions.
+////////////////////////////////////////////////////////////////////////////////////////////
+class TC_GAME_API SimpleGossipStateTracker
+{
+public:
+    static SimpleGossipStateTracker* instance();
+
+    void Bump(ObjectGuid guid, uint32 states);
+    // Bumps SIMPLEGOSSIP_STATE_ARENA_TEAM first when one of the player's arena team ids changed
+    SimpleGossipStateVersions const& Get(Player* player);
+    // Drops the player's versions and the render caches of every gossip
+    void Forget(ObjectGuid guid);
+
+    void RegisterGossip(SimpleGossip* gossip) { Gossips.insert(gossip); }
+    void UnregisterGossip(SimpleGossip* gossip) { Gossips.erase(gossip); PendingGossips.erase(gossip); }
+
+    // Gossips waiting on async option work, processed every world update until they are done
+    void SchedulePending(SimpleGossip* gossip) { PendingGossips.insert(gossip); }
+    void Update();
+
+private:
+    SimpleGossipPlayerStates& GetOrCreate(ObjectGuid guid);
+
+    uint32 NextVersion = 1;
+    std::unordered_map<ObjectGuid, SimpleGossipPlayerStates> Players;
+    std::unordered_set<SimpleGossip*> Gossips;
+    std::unordered_set<SimpleGossip*> PendingGossips;
+};
+
+#define sSimpleGossipState SimpleGossipStateTracker::instance()
+
+void AddSC_SimpleGossipState();
+
+#endif
@@ -0,0 +1,34 @@
+// This code is licensed under MIT license
+
+// Compile checks for SimpleGossipStatic. Dialogs are templates, so without a user nothing of the header
+// would be compiled with the rest of SimpleGossip. Taking the addresses of Show and Select instantiates every
+// member an item can reach without exporting anything, the static_asserts check the link validation.
+
+#include "SimpleGossipStatic.h"
+
+namespace
+{
+    namespace SGS = SimpleGossipStatic;
+
+    bool HasMoney(Player* player) { return player->GetMoney() > 0; }
+
+    constexpr auto Example = SGS::MakeDialog(
+        SGS::MakeMenu(2,
+            SGS::Option(GOSSIP_ICON_CHAT, "Next.", SGS::Nothing()).Goto(1),
+            SGS::Option(GOSSIP_ICON_CHAT, "Hidden without money.", SGS::Nothing()).If(HasMoney).Stay(),
+            SGS::Option(GOSSIP_ICON_CHAT, "Goodbye.", SGS::Nothing()).Close()),
+        SGS::MakeMenu(2,
+            SGS::Option(GOSSIP_ICON_TABARD, "Pay.", SGS::Nothing()).Popup("Are you sure?", 100),
+            SGS::Option(GOSSIP_ICON_CHAT, "Back.", SGS::Nothing()).Goto(0, 3)));
+
+    constexpr auto Dangling = SGS::MakeDialog(
+        SGS::MakeMenu(2, SGS::Option(GOSSIP_ICON_CHAT, "Nowhere.", SGS::Nothing()).Goto(1)));
+
+    static_assert(Example.IsValid(), "every Goto of the example leads to one of its menus");
+    static_assert(!Dangling.IsValid(), "a Goto past the last menu must be caught");
+    static_assert(Example.MenuCount == 2, "one dialog menu per MakeMenu");
+
+    typedef std::decay_t<decltype(Example)> ExampleDialog;
+    [[maybe_unused]] constexpr bool (ExampleDialog::*ShowExample)(Player*, ObjectGuid, uint16) const = &ExampleDialog::Show;
+    [[maybe_unused]] constexpr bool (ExampleDialog::*SelectExample)(Player*, uint32) const = &ExampleDialog::Select;
+}
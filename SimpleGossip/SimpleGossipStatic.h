@@ -0,0 +1,264 @@
+// This code is licensed under MIT license
+
+#ifndef _SIMPLEGOSSIPSTATIC_H
+#define _SIMPLEGOSSIPSTATIC_H
+
+#include "Define.h"
+#include "GossipDef.h"
+#include "Player.h"
+#include "ScriptedGossip.h"
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Compile time gossip menus.
+// A dialog is a constexpr tuple of menus, each a tuple of items holding their condition and
+// callback by type, so showing and selecting is unrolled per item and both get inlined.
+// Nothing is allocated and there is no option graph, the gossip action of an item is just
+// its menu and item index. Menus built at runtime keep using SimpleGossip.
+//
+//     static constexpr auto Dialog = SimpleGossipStatic::MakeDialog(
+//         SimpleGossipStatic::MakeMenu(2,
+//             SimpleGossipStatic::Option(GOSSIP_ICON_BATTLE, "Queue.", [](Player* player) { ... })
+//                 .If([](Player* player) { return !player->InBattlegroundQueue(); }),
+//             SimpleGossipStatic::Option(GOSSIP_ICON_TALK, "More.", SimpleGossipStatic::Nothing()).Goto(1)),
+//         SimpleGossipStatic::MakeMenu(2, ...));
+//     static_assert(Dialog.IsValid(), "menu links out of range");
+//
+// Callbacks take the player, popup items charging money also get whether it was paid.
+////////////////////////////////////////////////////////////////////////////////////////////
+namespace SimpleGossipStatic
+{
+    constexpr uint16 NEXT_RESTART = 0xFFFF;     // Back to the first menu
+    constexpr uint16 NEXT_CLOSE = 0xFFFE;
+    constexpr uint16 NEXT_NONE = 0xFFFD;        // Leave the menu to the callback
+
+    struct Always
+    {
+        constexpr bool operator()(Player* /*player*/) const { return true; }
+    };
+
+    struct Nothing
+    {
+        constexpr void operator()(Player* /*player*/) const { }
+        constexpr void operator()(Player* /*player*/, bool /*success*/) const { }
+    };
+
+    template<class Condition, class Callback>
+    struct Item
+    {
+        GossipOptionIcon Icon = GOSSIP_ICON_CHAT;
+        char const* Text = "";
+        char const* PopupText = nullptr;
+        uint32 PopupCopper = 0;
+        bool IsCoded = false;
+        uint16 Next = NEXT_RESTART;
+        uint32 NextTextId = 0;          // 0 uses the text of the next menu
+        Condition Show;
+        Callback Select;
+
+        template<class C>
+        constexpr Item<C, Callback> If(C condition) const
+        {
+            return { Icon, Text, PopupText, PopupCopper, IsCoded, Next, NextTextId, condition, Select };
+        }
+
+        constexpr Item Popup(char const* popupText, uint32 popupCopper = 0, bool isCoded = false) const
+        {
+            Item item = *this;
+            item.PopupText = popupText;
+            item.PopupCopper = popupCopper;
+            item.IsCoded = isCoded;
+            return item;
+        }
+
+        constexpr Item Goto(uint16 menu, uint32 textId = 0) const
+        {
+            Item item = *this;
+            item.Next = menu;
+            item.NextTextId = textId;
+            return item;
+        }
+
+        constexpr Item Close() const { return Goto(NEXT_CLOSE); }
+        constexpr Item Stay() const { return Goto(NEXT_NONE); }
+    };
+
+    template<class Callback>
+    constexpr Item<Always, Callback> Option(GossipOptionIcon icon, char const* text, Callback callback)
+    {
+        return { icon, text, nullptr, 0, false, NEXT_RESTART, 0, Always(), callback };
+    }
+
+    template<class... Items>
+    struct Menu
+    {
+        uint32 TextId;
+        std::tuple<Items...> Entries;
+
+        static constexpr uint16 ItemCount = sizeof...(Items);
+        static_assert(sizeof...(Items) < 0xFFFF, "too many items in one menu");
+    };
+
+    template<class... Items>
+    constexpr Menu<Items...> MakeMenu(uint32 textId, Items... items)
+    {
+        return { textId, std::tuple<Items...>(items...) };
+    }
+
+    template<class... Menus>
+    class Dialog
+    {
+    public:
+        static constexpr uint16 MenuCount = sizeof...(Menus);
+        static_assert(sizeof...(Menus) > 0 && sizeof...(Menus) < NEXT_NONE, "a dialog needs between 1 and 65532 menus");
+
+        constexpr explicit Dialog(Menus... menus) : Entries(menus...) { }
+
+        // Every Goto points at a menu of this dialog
+        constexpr bool IsValid() const { return IsValid(std::index_sequence_for<Menus...>()); }
+
+        bool Show(Player* player, ObjectGuid sender, uint16 menu = 0) const
+        {
+            return ShowWithText(player, sender, menu, 0);
+        }
+
+        // Only actions of the menu last sent to the player are accepted and items hidden by their condition are refused,
+        // so a forged action can neither jump to another menu's item nor run a hidden one
+        bool Select(Player* player, uint32 action) const
+        {
+            GossipMenu const& gossipMenu = player->PlayerTalkClass->GetGossipMenu();
+            if (!WasSent(gossipMenu, action))
+                return false;
+
+            ObjectGuid sender = gossipMenu.GetSenderGUID();
+            return SelectIn(player, sender, uint16(action >> 16), uint16(action & 0xFFFF), std::index_sequence_for<Menus...>());
+        }
+
+    private:
+        std::tuple<Menus...> Entries;
+
+        static bool WasSent(GossipMenu const& gossipMenu, uint32 action)
+        {
+            for (auto const& [id, item] : gossipMenu.GetMenuItems())
+                if (item.Sender == GOSSIP_SENDER_MAIN && item.OptionType == action)
+                    return true;
+            return false;
+        }
+
+        // textId 0 uses the menu's own text
+        bool ShowWithText(Player* player, ObjectGuid sender, uint16 menu, uint32 textId) const
+        {
+            ClearGossipMenuFor(player);
+            return ShowIn(player, sender, menu, textId, std::index_sequence_for<Menus...>());
+        }
+
+        template<size_t... M>
+        bool ShowIn(Player* player, ObjectGuid sender, uint16 menu, uint32 textId, std::index_sequence<M...>) const
+        {
+            return ((menu == M && ShowMenu<M>(player, sender, textId)) || ...);
+        }
+
+        template<size_t M>
+        bool ShowMenu(Player* player, ObjectGuid sender, uint32 textId) const
+        {
+            auto const& entry = std::get<M>(Entries);
+            AddItems<M>(player, entry.Entries, std::make_index_sequence<std::tuple_size_v<std::decay_t<decltype(entry.Entries)>>>());
+            SendGossipMenuFor(player, textId ? textId : entry.TextId, sender);
+            return true;
+        }
+
+        template<size_t M, class Tuple, size_t... I>
+        void AddItems(Player* player, Tuple const& items, std::index_sequence<I...>) const
+        {
+            (AddItem(player, std::get<I>(items), (uint32(M) << 16) | uint32(I)), ...);
+        }
+
+        template<class Condition, class Callback>
+        static void AddItem(Player* player, Item<Condition, Callback> const& item, uint32 action)
+        {
+            if (!item.Show(player))
+                return;
+
+            if (item.PopupText)
+                AddGossipItemFor(player, item.Icon, item.Text, GOSSIP_SENDER_MAIN, action, item.PopupText, item.PopupCopper, item.IsCoded);
+            else
+                AddGossipItemFor(player, item.Icon, item.Text, GOSSIP_SENDER_MAIN, action);
+        }
+
+        template<size_t... M>
+        bool SelectIn(Player* player, ObjectGuid sender, uint16 menu, uint16 index, std::index_sequence<M...>) const
+        {
+            return ((menu == M && SelectMenu<M>(player, sender, index)) || ...);
+        }
+
+        template<size_t M>
+        bool SelectMenu(Player* player, ObjectGuid sender, uint16 index) const
+        {
+            auto const& items = std::get<M>(Entries).Entries;
+            return SelectItem(player, sender, items, index, std::make_index_sequence<std::tuple_size_v<std::decay_t<decltype(items)>>>());
+        }
+
+        template<class Tuple, size_t... I>
+        bool SelectItem(Player* player, ObjectGuid sender, Tuple const& items, uint16 index, std::index_sequence<I...>) const
+        {
+            return ((index == I && Run(player, sender, std::get<I>(items))) || ...);
+        }
+
+        // Same order as SimpleGossipOption: the callback first, then the next menu
+        template<class Condition, class Callback>
+        bool Run(Player* player, ObjectGuid sender, Item<Condition, Callback> const& item) const
+        {
+            if (!item.Show(player))
+                return false;
+
+            ClearGossipMenuFor(player);
+            if constexpr (std::is_invocable_v<Callback const&, Player*, bool>)
+            {
+                bool success = false;
+                if (player->GetMoney() >= item.PopupCopper && player->ModifyMoney(int32(item.PopupCopper) * -1))
+                    success = true;
+                item.Select(player, success);
+            }
+            else
+                item.Select(player);
+
+            switch (item.Next)
+            {
+                case NEXT_NONE:
+                    break;
+                case NEXT_CLOSE:
+                    CloseGossipMenuFor(player);
+                    break;
+                case NEXT_RESTART:
+                    ShowWithText(player, sender, 0, 0);
+                    break;
+                default:
+                    ShowWithText(player, sender, item.Next, item.NextTextId);
+                    break;
+            }
+            return true;
+        }
+
+        template<size_t... M>
+        constexpr bool IsValid(std::index_sequence<M...>) const
+        {
+            return (MenuLinksValid(std::get<M>(Entries).Entries, std::make_index_sequence<std::tuple_size_v<std::decay_t<decltype(std::get<M>(Entries).Entries)>>>()) && ...);
+        }
+
+        template<class Tuple, size_t... I>
+        static constexpr bool MenuLinksValid(Tuple const& items, std::index_sequence<I...>)
+        {
+            return ((std::get<I>(items).Next >= NEXT_NONE || std::get<I>(items).Next < MenuCount) && ...);
+        }
+    };
+
+    template<class... Menus>
+    constexpr Dialog<Menus...> MakeDialog(Menus... menus)
+    {
+        return Dialog<Menus...>(menus...);
+    }
+}
+
+#endif
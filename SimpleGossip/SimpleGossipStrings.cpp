@@ -0,0 +1,72 @@
+// This code is licensed under MIT license
+
+#include "SimpleGossipStrings.h"
+#include "Player.h"
+#include "WorldSession.h"
+
+SimpleGossipText::SimpleGossipText(std::string_view text) : Id(sSimpleGossipStrings->Intern(text).Id) { }
+
+std::string const& SimpleGossipText::Get(LocaleConstant locale) const
+{
+    return sSimpleGossipStrings->Get(*this, locale);
+}
+
+SimpleGossipStrings* SimpleGossipStrings::instance()
+{
+    static SimpleGossipStrings instance;
+    return &instance;
+}
+
+// Handle 0 and string 0 are both the empty text
+SimpleGossipStrings::SimpleGossipStrings()
+{
+    Strings.emplace_back();
+    Entries.emplace_back();
+}
+
+SimpleGossipText SimpleGossipStrings::Intern(std::string_view text)
+{
+    SimpleGossipText handle;
+    if (text.empty())
+        return handle;
+
+    auto itr = Index.find(text);
+    if (itr != Index.end())
+    {
+        handle.Id = itr->second;
+        return handle;
+    }
+
+    handle.Id = uint32(Entries.size());
+    Entry& entry = Entries.emplace_back();
+    entry.Strings[LOCALE_enUS] = uint32(Strings.size());
+    std::string const& stored = Strings.emplace_back(text);
+    Index.emplace(std::string_view(stored), handle.Id);
+    return handle;
+}
+
+// Setting a locale again replaces its text, the old string stays unused
+void SimpleGossipStrings::SetLocaleText(SimpleGossipText text, LocaleConstant locale, std::string_view localized)
+{
+    if (text.IsEmpty() || text.Id >= Entries.size() || locale >= TOTAL_LOCALES || locale == LOCALE_enUS)
+        return;
+
+    Entries[text.Id].Strings[locale] = uint32(Strings.size());
+    Strings.emplace_back(localized);
+}
+
+std::string const& SimpleGossipStrings::Get(SimpleGossipText text, LocaleConstant locale) const
+{
+    if (text.Id >= Entries.size())
+        return Strings[0];
+
+    Entry const& entry = Entries[text.Id];
+    uint32 index = locale < TOTAL_LOCALES ? entry.Strings[locale] : 0;
+    return Strings[index ? index : entry.Strings[LOCALE_enUS]];
+}
+
+LocaleConstant SimpleGossipStrings::GetLocale(Player* player)
+{
+    LocaleConstant locale = player->GetSession()->GetSessionDbLocaleIndex();
+    return locale < TOTAL_LOCALES ? locale : LOCALE_enUS;
+}
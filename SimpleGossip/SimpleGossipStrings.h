@@ -0,0 +1,71 @@
+// This code is licensed under MIT license
+
+#ifndef _SIMPLEGOSSIPSTRINGS_H
+#define _SIMPLEGOSSIPSTRINGS_H
+
+#include "Define.h"
+#include "Common.h"
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class Player;
+
+// Handle of an interned option text, 0 is the empty text. Assigning a string interns it.
+struct SimpleGossipText
+{
+    uint32 Id = 0;
+
+    SimpleGossipText() = default;
+    SimpleGossipText(std::string_view text);
+    SimpleGossipText(std::string const& text) : SimpleGossipText(std::string_view(text)) { }
+    SimpleGossipText(char const* text) : SimpleGossipText(std::string_view(text)) { }
+
+    bool IsEmpty() const { return Id == 0; }
+    // The localized text, the enUS one where the locale has none
+    std::string const& Get(LocaleConstant locale = LOCALE_enUS) const;
+
+    bool operator==(SimpleGossipText const& other) const { return Id == other.Id; }
+    bool operator!=(SimpleGossipText const& other) const { return Id != other.Id; }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Option texts of every SimpleGossip, interned once by their enUS text.
+// Options only hold handles, equal texts share one string however many gossips use them,
+// and each text may carry translations. Lookups hand out the stored std::string, so sending
+// an item never copies its text. Options are built before they know their gossip, so there
+// is one table for all of them rather than one per gossip. Pre-encoded pages copy the texts
+// when finalized, a gossip needs a new Finalize to pick up translations added later.
+////////////////////////////////////////////////////////////////////////////////////////////
+class TC_GAME_API SimpleGossipStrings
+{
+public:
+    static SimpleGossipStrings* instance();
+
+    SimpleGossipText Intern(std::string_view text);
+    void SetLocaleText(SimpleGossipText text, LocaleConstant locale, std::string_view localized);
+    std::string const& Get(SimpleGossipText text, LocaleConstant locale) const;
+
+    // The player's locale, enUS for anything the table has no slot for
+    static LocaleConstant GetLocale(Player* player);
+
+    size_t Size() const { return Entries.size(); }
+
+private:
+    SimpleGossipStrings();
+
+    struct Entry
+    {
+        uint32 Strings[TOTAL_LOCALES] = { };   // Index in Strings per locale, 0 falls back to enUS
+    };
+
+    std::deque<std::string> Strings;            // Never erased, so the views in Index stay valid
+    std::vector<Entry> Entries;
+    std::unordered_map<std::string_view, uint32> Index;     // enUS text -> handle
+};
+
+#define sSimpleGossipStrings SimpleGossipStrings::instance()
+
+#endif
@@ -0,0 +1,496 @@
+// This code is licensed under MIT license
+
+// Standalone Solo Arena queue broker.
+// Worldservers connect to it and forward their 1v1 queue joins and leaves, the broker keeps one
+// matchmaker rating ordered pool per bracket and answers with batched pairing decisions.
+// Players are only paired with players of their own realm, see CanHost.
+//
+// Usage: soloarena-broker <unix:/path/to/socket | tcp:host:port> [pairing interval ms]
+
+#include "../SoloArenaBrokerProtocol.h"
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+using namespace SoloArenaBroker;
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // Rated pairs start within this matchmaker rating window which widens the longer both players wait
+    constexpr uint32_t MMR_WINDOW_BASE = 100;
+    constexpr uint32_t MMR_WINDOW_STEP = 25;
+    constexpr uint32_t MMR_WINDOW_STEP_MS = 10000;
+    constexpr uint32_t MMR_WINDOW_MAX = 1000;
+
+    volatile std::sig_atomic_t Running = 1;
+
+    void HandleSignal(int /*signal*/) { Running = 0; }
+
+    struct Connection
+    {
+        int Fd = -1;
+        uint32_t RealmId = 0;
+        bool Greeted = false;
+        std::vector<uint8_t> In;
+        std::vector<uint8_t> Out;
+        FrameWriter Pending;
+    };
+
+    struct Entry
+    {
+        uint64_t PlayerGuid;
+        uint32_t RealmId;
+        uint32_t MatchmakerRating;
+        Clock::time_point JoinedAt;
+    };
+
+    // One pool per (bracket, rated), ordered by matchmaker rating
+    typedef std::multimap<uint32_t, Entry> Pool;
+
+    uint64_t PoolKey(uint8_t bracketId, bool rated) { return uint64_t(bracketId) << 1 | (rated ? 1 : 0); }
+    uint64_t PlayerKey(uint32_t realmId, uint64_t guid) { return uint64_t(realmId) << 40 ^ guid; }
+
+    class Broker
+    {
+    public:
+        bool Listen(std::string const& address);
+        void Run(uint32_t pairingIntervalMs);
+
+    private:
+        void Accept();
+        bool Receive(Connection& connection);
+        bool Send(Connection& connection);
+        void Close(Connection& connection);
+
+        void HandleJoin(Connection& connection, Join const& msg);
+        void HandleLeave(Connection& connection, Leave const& msg);
+        void RemoveEntry(uint64_t playerKey);
+        void RemoveRealm(uint32_t realmId);
+        void PairingPass();
+        void EmitPair(uint64_t poolKey, Entry const& first, Entry const& second);
+        Connection* FindRealm(uint32_t realmId);
+
+        static bool CanHost(Entry const& first, Entry const& second);
+        static uint32_t GetWindow(Entry const& entry, Clock::time_point now);
+
+        int _listenFd = -1;
+        std::string _unixPath;
+        std::vector<std::unique_ptr<Connection>> _connections;
+        std::map<uint64_t, Pool> _pools;
+        std::unordered_map<uint64_t, std::pair<uint64_t, Pool::iterator>> _entries;
+        uint64_t _pairsEmitted = 0;
+    };
+
+    bool SetNonBlocking(int fd)
+    {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    bool Broker::Listen(std::string const& address)
+    {
+        if (address.compare(0, 5, "unix:") == 0)
+        {
+            _unixPath = address.substr(5);
+            sockaddr_un addr = {};
+            if (_unixPath.empty() || _unixPath.size() >= sizeof(addr.sun_path))
+            {
+                std::fprintf(stderr, "Invalid unix socket path '%s'\n", _unixPath.c_str());
+                return false;
+            }
+
+            addr.sun_family = AF_UNIX;
+            std::memcpy(addr.sun_path, _unixPath.c_str(), _unixPath.size());
+            unlink(_unixPath.c_str());
+
+            _listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (_listenFd < 0 || bind(_listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+            {
+                std::perror("bind");
+                return false;
+            }
+        }
+        else if (address.compare(0, 4, "tcp:") == 0)
+        {
+            std::string hostPort = address.substr(4);
+            size_t colon = hostPort.rfind(':');
+            if (colon == std::string::npos)
+            {
+                std::fprintf(stderr, "Expected tcp:host:port, got '%s'\n", address.c_str());
+                return false;
+            }
+
+            addrinfo hints = {};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags = AI_PASSIVE;
+            addrinfo* result = nullptr;
+            if (getaddrinfo(hostPort.substr(0, colon).c_str(), hostPort.substr(colon + 1).c_str(), &hints, &result) != 0 || !result)
+            {
+                std::fprintf(stderr, "Unable to resolve '%s'\n", address.c_str());
+                return false;
+            }
+
+            _listenFd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+            int reuse = 1;
+            if (_listenFd >= 0)
+                setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            bool bound = _listenFd >= 0 && bind(_listenFd, result->ai_addr, result->ai_addrlen) == 0;
+            freeaddrinfo(result);
+            if (!bound)
+            {
+                std::perror("bind");
+                return false;
+            }
+        }
+        else
+        {
+            std::fprintf(stderr, "Unknown address '%s', use unix:/path or tcp:host:port\n", address.c_str());
+            return false;
+        }
+
+        if (listen(_listenFd, 16) != 0 || !SetNonBlocking(_listenFd))
+        {
+            std::perror("listen");
+            return false;
+        }
+
+        std::printf("Solo Arena broker listening on %s\n", address.c_str());
+        return true;
+    }
+
+    void Broker::Run(uint32_t pairingIntervalMs)
+    {
+        Clock::time_point nextPass = Clock::now();
+        std::vector<pollfd> fds;
+
+        while (Running)
+        {
+            fds.clear();
+            fds.push_back({ _listenFd, POLLIN, 0 });
+            for (auto const& connection : _connections)
+                fds.push_back({ connection->Fd, short(POLLIN | (connection->Out.empty() ? 0 : POLLOUT)), 0 });
+
+            int timeout = int(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::milliseconds>(nextPass - Clock::now()).count()));
+            if (poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR)
+            {
+                std::perror("poll");
+                break;
+            }
+
+            if (fds[0].revents & POLLIN)
+                Accept();
+
+            for (size_t i = 1; i < fds.size(); ++i)
+            {
+                Connection& connection = *_connections[i - 1];
+                if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL))
+                    Close(connection);
+                else if ((fds[i].revents & POLLIN) && !Receive(connection))
+                    Close(connection);
+                else if ((fds[i].revents & POLLOUT) && !Send(connection))
+                    Close(connection);
+            }
+
+            _connections.erase(std::remove_if(_connections.begin(), _connections.end(),
+                [](std::unique_ptr<Connection> const& connection) { return connection->Fd < 0; }), _connections.end());
+
+            if (Clock::now() >= nextPass)
+            {
+                PairingPass();
+                for (auto const& connection : _connections)
+                {
+                    if (connection->Pending.Empty())
+                        continue;
+
+                    std::vector<uint8_t> const& frame = connection->Pending.Finish();
+                    connection->Out.insert(connection->Out.end(), frame.begin(), frame.end());
+                    connection->Pending.Reset();
+                    if (!Send(*connection))
+                        Close(*connection);
+                }
+                nextPass = Clock::now() + std::chrono::milliseconds(pairingIntervalMs);
+            }
+        }
+
+        for (auto const& connection : _connections)
+            Close(*connection);
+        close(_listenFd);
+        if (!_unixPath.empty())
+            unlink(_unixPath.c_str());
+
+        std::printf("Solo Arena broker stopped after emitting %llu pairs\n", static_cast<unsigned long long>(_pairsEmitted));
+    }
+
+    void Broker::Accept()
+    {
+        while (true)
+        {
+            int fd = accept(_listenFd, nullptr, nullptr);
+            if (fd < 0)
+                return;
+
+            if (!SetNonBlocking(fd))
+            {
+                close(fd);
+                continue;
+            }
+
+            std::unique_ptr<Connection> connection = std::make_unique<Connection>();
+            connection->Fd = fd;
+            _connections.push_back(std::move(connection));
+        }
+    }
+
+    bool Broker::Receive(Connection& connection)
+    {
+        uint8_t buffer[16 * 1024];
+        while (true)
+        {
+            ssize_t received = recv(connection.Fd, buffer, sizeof(buffer), 0);
+            if (received == 0)
+                return false;
+            if (received < 0)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    break;
+                return errno == EINTR;
+            }
+            connection.In.insert(connection.In.end(), buffer, buffer + received);
+        }
+
+        bool valid = true;
+        size_t consumed = ParseFrames(connection.In.data(), connection.In.size(), [&](auto const& msg)
+        {
+            typedef std::decay_t<decltype(msg)> Message;
+            if constexpr (std::is_same_v<Message, Hello>)
+            {
+                if (msg.Version != PROTOCOL_VERSION || FindRealm(msg.RealmId))
+                {
+                    valid = false;
+                    return;
+                }
+                connection.RealmId = msg.RealmId;
+                connection.Greeted = true;
+                std::printf("Realm %u connected\n", msg.RealmId);
+            }
+            else if constexpr (std::is_same_v<Message, Join>)
+            {
+                if (connection.Greeted)
+                    HandleJoin(connection, msg);
+                else
+                    valid = false;
+            }
+            else if constexpr (std::is_same_v<Message, Leave>)
+            {
+                if (connection.Greeted)
+                    HandleLeave(connection, msg);
+                else
+                    valid = false;
+            }
+            else
+                valid = false; // pairs only ever travel broker -> worldserver
+        });
+
+        if (consumed == PARSE_ERROR || !valid)
+            return false;
+
+        connection.In.erase(connection.In.begin(), connection.In.begin() + consumed);
+        return true;
+    }
+
+    bool Broker::Send(Connection& connection)
+    {
+        while (!connection.Out.empty())
+        {
+            ssize_t sent = send(connection.Fd, connection.Out.data(), connection.Out.size(), MSG_NOSIGNAL);
+            if (sent < 0)
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            connection.Out.erase(connection.Out.begin(), connection.Out.begin() + sent);
+        }
+        return true;
+    }
+
+    void Broker::Close(Connection& connection)
+    {
+        if (connection.Fd < 0)
+            return;
+
+        if (connection.Greeted)
+        {
+            // The worldserver resyncs its queue when it reconnects, so forget everything it had queued
+            RemoveRealm(connection.RealmId);
+            std::printf("Realm %u disconnected\n", connection.RealmId);
+        }
+
+        close(connection.Fd);
+        connection.Fd = -1;
+    }
+
+    void Broker::HandleJoin(Connection& connection, Join const& msg)
+    {
+        uint64_t playerKey = PlayerKey(connection.RealmId, msg.PlayerGuid);
+        RemoveEntry(playerKey);
+
+        uint64_t poolKey = PoolKey(msg.BracketId, msg.Rated != 0);
+        Entry entry{ msg.PlayerGuid, connection.RealmId, msg.MatchmakerRating, Clock::now() - std::chrono::milliseconds(msg.WaitedMs) };
+        Pool::iterator itr = _pools[poolKey].emplace(msg.Rated ? msg.MatchmakerRating : 0, entry);
+        _entries[playerKey] = { poolKey, itr };
+    }
+
+    void Broker::HandleLeave(Connection& connection, Leave const& msg)
+    {
+        RemoveEntry(PlayerKey(connection.RealmId, msg.PlayerGuid));
+    }
+
+    void Broker::RemoveEntry(uint64_t playerKey)
+    {
+        auto itr = _entries.find(playerKey);
+        if (itr == _entries.end())
+            return;
+
+        _pools[itr->second.first].erase(itr->second.second);
+        _entries.erase(itr);
+    }
+
+    void Broker::RemoveRealm(uint32_t realmId)
+    {
+        for (auto itr = _entries.begin(); itr != _entries.end();)
+        {
+            if (itr->second.second->second.RealmId == realmId)
+            {
+                _pools[itr->second.first].erase(itr->second.second);
+                itr = _entries.erase(itr);
+            }
+            else
+                ++itr;
+        }
+    }
+
+    Connection* Broker::FindRealm(uint32_t realmId)
+    {
+        for (auto const& connection : _connections)
+            if (connection->Fd >= 0 && connection->Greeted && connection->RealmId == realmId)
+                return connection.get();
+        return nullptr;
+    }
+
+    // A battleground lives on a single worldserver and the core can't host players connected to another one,
+    // so both players must be of the same realm. Queues of different realms are never pooled.
+    bool Broker::CanHost(Entry const& first, Entry const& second)
+    {
+        return first.RealmId == second.RealmId;
+    }
+
+    uint32_t Broker::GetWindow(Entry const& entry, Clock::time_point now)
+    {
+        uint64_t waited = uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(now - entry.JoinedAt).count());
+        return uint32_t(std::min<uint64_t>(MMR_WINDOW_MAX, MMR_WINDOW_BASE + waited / MMR_WINDOW_STEP_MS * MMR_WINDOW_STEP));
+    }
+
+    // Walks every pool in rating order and pairs each entry with the closest unpaired entry below it
+    // that can share a battleground with it.
+    void Broker::PairingPass()
+    {
+        Clock::time_point now = Clock::now();
+
+        for (auto& [poolKey, pool] : _pools)
+        {
+            bool rated = (poolKey & 1) != 0;
+            std::unordered_map<uint32_t, Pool::iterator> waiting;
+
+            for (Pool::iterator itr = pool.begin(); itr != pool.end();)
+            {
+                Entry const& entry = itr->second;
+                auto candidate = waiting.find(entry.RealmId);
+                if (candidate != waiting.end() && CanHost(candidate->second->second, entry))
+                {
+                    Entry const& other = candidate->second->second;
+                    uint32_t window = std::max(GetWindow(entry, now), GetWindow(other, now));
+                    if (!rated || entry.MatchmakerRating - other.MatchmakerRating <= window)
+                    {
+                        EmitPair(poolKey, other, entry);
+
+                        _entries.erase(PlayerKey(other.RealmId, other.PlayerGuid));
+                        _entries.erase(PlayerKey(entry.RealmId, entry.PlayerGuid));
+                        pool.erase(candidate->second);
+                        itr = pool.erase(itr);
+                        waiting.erase(candidate);
+                        continue;
+                    }
+                }
+
+                waiting[entry.RealmId] = itr;
+                ++itr;
+            }
+        }
+    }
+
+    void Broker::EmitPair(uint64_t poolKey, Entry const& first, Entry const& second)
+    {
+        Pair pair{ first.PlayerGuid, first.RealmId, second.PlayerGuid, second.RealmId, uint8_t(poolKey >> 1), uint8_t(poolKey & 1) };
+
+        Connection* firstConnection = FindRealm(first.RealmId);
+        Connection* secondConnection = FindRealm(second.RealmId);
+        for (Connection* connection : { firstConnection, secondConnection })
+        {
+            if (!connection)
+                continue;
+
+            if (connection->Pending.Full())
+            {
+                std::vector<uint8_t> const& frame = connection->Pending.Finish();
+                connection->Out.insert(connection->Out.end(), frame.begin(), frame.end());
+                connection->Pending.Reset();
+            }
+            connection->Pending.Add(pair);
+
+            if (firstConnection == secondConnection)
+                break;
+        }
+
+        ++_pairsEmitted;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "Usage: %s <unix:/path/to/socket | tcp:host:port> [pairing interval ms]\n", argv[0]);
+        return 1;
+    }
+
+    uint32_t pairingIntervalMs = argc > 2 ? uint32_t(std::max(1, std::atoi(argv[2]))) : 250;
+
+    std::signal(SIGINT, HandleSignal);
+    std::signal(SIGTERM, HandleSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    Broker broker;
+    if (!broker.Listen(argv[1]))
+        return 1;
+
+    broker.Run(pairingIntervalMs);
+    return 0;
+}
@@ -0,0 +1,224 @@
+// This code is licensed under MIT license
+
+#include "SoloArenaBrokerClient.h"
+#include "Log.h"
+#include "Timer.h"
+#include <boost/asio/local/stream_protocol.hpp>
+#include <type_traits>
+
+using namespace SoloArenaBroker;
+
+namespace
+{
+    // A broker that neither accepts nor refuses within this many ms is given up on until the next attempt
+    constexpr uint32 CONNECT_TIMEOUT = 5000;
+}
+
+SoloArenaBrokerClient::SoloArenaBrokerClient() : _socket(_ioContext), _resolver(_ioContext)
+{
+}
+
+SoloArenaBrokerClient::~SoloArenaBrokerClient()
+{
+    Disconnect();
+}
+
+bool SoloArenaBrokerClient::Connect(std::string const& address, uint32 realmId)
+{
+    Disconnect();
+
+    uint32 attempt = ++_attempt;
+    if (address.compare(0, 5, "unix:") == 0)
+    {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+        boost::asio::local::stream_protocol::endpoint endpoint(address.substr(5));
+        _socket.async_connect(boost::asio::generic::stream_protocol::endpoint(endpoint), [this, attempt](boost::system::error_code const& error)
+        {
+            OnConnected(error, attempt);
+        });
+#else
+        TC_LOG_ERROR("bg.arena", "SoloArenaBrokerClient: unix sockets are not supported on this platform, use tcp:host:port.");
+        return false;
+#endif
+    }
+    else if (address.compare(0, 4, "tcp:") == 0)
+    {
+        std::string hostPort = address.substr(4);
+        size_t colon = hostPort.rfind(':');
+        if (colon == std::string::npos)
+        {
+            TC_LOG_ERROR("bg.arena", "SoloArenaBrokerClient: invalid address '%s', expected tcp:host:port.", address.c_str());
+            return false;
+        }
+
+        _resolver.async_resolve(hostPort.substr(0, colon), hostPort.substr(colon + 1),
+            [this, attempt](boost::system::error_code const& error, boost::asio::ip::tcp::resolver::results_type const& endpoints)
+        {
+            if (attempt != _attempt)
+                return;
+
+            if (error || endpoints.begin() == endpoints.end())
+            {
+                OnConnected(error ? error : boost::asio::error::host_not_found, attempt);
+                return;
+            }
+
+            _socket.async_connect(boost::asio::generic::stream_protocol::endpoint(endpoints.begin()->endpoint()), [this, attempt](boost::system::error_code const& connectError)
+            {
+                OnConnected(connectError, attempt);
+            });
+        });
+    }
+    else
+    {
+        TC_LOG_ERROR("bg.arena", "SoloArenaBrokerClient: unknown address '%s', use unix:/path or tcp:host:port.", address.c_str());
+        return false;
+    }
+
+    _state = STATE_CONNECTING;
+    _connectStart = getMSTime();
+    _realmId = realmId;
+    _address = address;
+    return true;
+}
+
+void SoloArenaBrokerClient::OnConnected(boost::system::error_code const& error, uint32 attempt)
+{
+    if (attempt != _attempt || _state != STATE_CONNECTING)
+        return;
+
+    if (error)
+    {
+        TC_LOG_DEBUG("bg.arena", "SoloArenaBrokerClient: unable to connect to '%s': %s", _address.c_str(), error.message().c_str());
+        Disconnect();
+        return;
+    }
+
+    boost::system::error_code nonBlockingError;
+    _socket.non_blocking(true, nonBlockingError);
+    _pending.Add(Hello{ PROTOCOL_VERSION, _realmId });
+    _state = STATE_CONNECTED;
+
+    TC_LOG_INFO("bg.arena", "SoloArenaBrokerClient: connected to '%s'.", _address.c_str());
+}
+
+bool SoloArenaBrokerClient::UpdateConnecting()
+{
+    if (_state != STATE_CONNECTING)
+        return _state == STATE_CONNECTED;
+
+    _ioContext.restart();
+    _ioContext.poll();
+
+    if (_state == STATE_CONNECTING && GetMSTimeDiffToNow(_connectStart) > CONNECT_TIMEOUT)
+    {
+        TC_LOG_DEBUG("bg.arena", "SoloArenaBrokerClient: connecting to '%s' timed out.", _address.c_str());
+        Disconnect();
+    }
+
+    return _state != STATE_DISCONNECTED;
+}
+
+void SoloArenaBrokerClient::Disconnect()
+{
+    ++_attempt;
+    _state = STATE_DISCONNECTED;
+    _resolver.cancel();
+    if (_socket.is_open())
+    {
+        boost::system::error_code error;
+        _socket.close(error);
+    }
+
+    _pending.Reset();
+    _out.clear();
+    _in.clear();
+}
+
+void SoloArenaBrokerClient::QueueJoin(uint64 playerGuid, uint32 matchmakerRating, uint32 waitedMs, uint8 bracketId, bool rated)
+{
+    if (!IsConnected())
+        return;
+
+    if (_pending.Full())
+        Flush();
+    _pending.Add(Join{ playerGuid, matchmakerRating, waitedMs, bracketId, uint8(rated ? 1 : 0) });
+}
+
+void SoloArenaBrokerClient::QueueLeave(uint64 playerGuid)
+{
+    if (!IsConnected())
+        return;
+
+    if (_pending.Full())
+        Flush();
+    _pending.Add(Leave{ playerGuid });
+}
+
+bool SoloArenaBrokerClient::Flush()
+{
+    if (!_pending.Empty())
+    {
+        std::vector<uint8> const& frame = _pending.Finish();
+        _out.insert(_out.end(), frame.begin(), frame.end());
+        _pending.Reset();
+    }
+
+    boost::system::error_code error;
+    while (!_out.empty())
+    {
+        size_t sent = _socket.write_some(boost::asio::buffer(_out), error);
+        if (error == boost::asio::error::would_block)
+            break;
+        if (error)
+            return false;
+        _out.erase(_out.begin(), _out.begin() + sent);
+    }
+
+    return true;
+}
+
+bool SoloArenaBrokerClient::Update(PairHandler const& handler)
+{
+    if (!IsConnected())
+        return false;
+
+    if (!Flush())
+    {
+        TC_LOG_ERROR("bg.arena", "SoloArenaBrokerClient: lost connection to the broker while sending.");
+        Disconnect();
+        return false;
+    }
+
+    boost::system::error_code error;
+    uint8 buffer[4096];
+    while (true)
+    {
+        size_t received = _socket.read_some(boost::asio::buffer(buffer), error);
+        if (error == boost::asio::error::would_block)
+            break;
+        if (error)
+        {
+            TC_LOG_ERROR("bg.arena", "SoloArenaBrokerClient: lost connection to the broker: %s", error.message().c_str());
+            Disconnect();
+            return false;
+        }
+        _in.insert(_in.end(), buffer, buffer + received);
+    }
+
+    size_t consumed = ParseFrames(_in.data(), _in.size(), [&](auto const& msg)
+    {
+        if constexpr (std::is_same_v<std::decay_t<decltype(msg)>, Pair>)
+            handler(msg);
+    });
+
+    if (consumed == PARSE_ERROR)
+    {
+        TC_LOG_ERROR("bg.arena", "SoloArenaBrokerClient: received a malformed frame, dropping the connection.");
+        Disconnect();
+        return false;
+    }
+
+    _in.erase(_in.begin(), _in.begin() + consumed);
+    return true;
+}
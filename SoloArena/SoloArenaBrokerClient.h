@@ -0,0 +1,70 @@
+// This code is licensed under MIT license
+
+#ifndef _SOLOARENABROKERCLIENT_H
+#define _SOLOARENABROKERCLIENT_H
+
+#include "Define.h"
+#include "SoloArenaBrokerProtocol.h"
+#include <boost/asio/generic/stream_protocol.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Worldserver side of the Solo Arena queue broker connection.
+// Messages are only batched by the Queue* calls, nothing touches the socket until Update
+// which flushes the batch as one frame and hands every received pairing to the callback.
+// The socket is non blocking and connecting is asynchronous, the world thread drives both
+// through Update and never waits on the broker, not even while it can't be reached.
+////////////////////////////////////////////////////////////////////////////////////////////
+class TC_GAME_API SoloArenaBrokerClient
+{
+public:
+    typedef std::function<void(SoloArenaBroker::Pair const& pair)> PairHandler;
+
+    SoloArenaBrokerClient();
+    ~SoloArenaBrokerClient();
+
+    // Address is either "unix:/path/to/socket" or "tcp:host:port". Only starts connecting,
+    // returns false when the address can't be used at all.
+    bool Connect(std::string const& address, uint32 realmId);
+    void Disconnect();
+    bool IsConnecting() const { return _state == STATE_CONNECTING; }
+    bool IsConnected() const { return _state == STATE_CONNECTED; }
+
+    void QueueJoin(uint64 playerGuid, uint32 matchmakerRating, uint32 waitedMs, uint8 bracketId, bool rated);
+    void QueueLeave(uint64 playerGuid);
+
+    // Runs the pending resolve and connect steps without blocking, returns false when connecting failed or timed out
+    bool UpdateConnecting();
+    // Returns false when the connection was lost
+    bool Update(PairHandler const& handler);
+
+private:
+    enum State
+    {
+        STATE_DISCONNECTED,
+        STATE_CONNECTING,
+        STATE_CONNECTED
+    };
+
+    bool Flush();
+    void OnConnected(boost::system::error_code const& error, uint32 attempt);
+
+    State _state = STATE_DISCONNECTED;
+    uint32 _attempt = 0;                    // completions of an abandoned attempt are ignored
+    uint32 _connectStart = 0;
+    uint32 _realmId = 0;
+    std::string _address;
+
+    boost::asio::io_context _ioContext;
+    boost::asio::generic::stream_protocol::socket _socket;
+    boost::asio::ip::tcp::resolver _resolver;
+    SoloArenaBroker::FrameWriter _pending;
+    std::vector<uint8> _out;
+    std::vector<uint8> _in;
+};
+
+#endif
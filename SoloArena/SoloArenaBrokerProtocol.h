@@ -0,0 +1,233 @@
+// This code is licensed under MIT license
+
+#ifndef _SOLOARENABROKERPROTOCOL_H
+#define _SOLOARENABROKERPROTOCOL_H
+
+// Wire protocol spoken between the worldservers and the Solo Arena queue broker.
+// This header is shared with the standalone broker, so it must not pull in any TrinityCore headers.
+//
+// Everything is little endian. Messages are never sent on their own, they are batched into frames:
+//   uint32 payloadSize | uint16 messageCount | messageCount * (uint8 opcode | fixed size body)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SoloArenaBroker
+{
+    constexpr uint32_t PROTOCOL_VERSION = 1;
+    constexpr size_t FRAME_HEADER_SIZE = 6;
+    constexpr size_t MAX_FRAME_PAYLOAD = 64 * 1024;
+    constexpr size_t PARSE_ERROR = SIZE_MAX;
+
+    enum Opcode : uint8_t
+    {
+        OPCODE_HELLO = 1,   // worldserver -> broker, first message on a connection
+        OPCODE_JOIN  = 2,   // worldserver -> broker, a player entered the 1v1 queue
+        OPCODE_LEAVE = 3,   // worldserver -> broker, a player left the 1v1 queue
+        OPCODE_PAIR  = 4    // broker -> worldserver, two queued players should fight each other
+    };
+
+    struct Hello
+    {
+        uint32_t Version;
+        uint32_t RealmId;
+    };
+
+    struct Join
+    {
+        uint64_t PlayerGuid;
+        uint32_t MatchmakerRating;
+        uint32_t WaitedMs;          // time already spent in the queue, non zero when resyncing after a reconnect
+        uint8_t BracketId;
+        uint8_t Rated;
+    };
+
+    struct Leave
+    {
+        uint64_t PlayerGuid;
+    };
+
+    struct Pair
+    {
+        uint64_t FirstGuid;
+        uint32_t FirstRealmId;
+        uint64_t SecondGuid;
+        uint32_t SecondRealmId;
+        uint8_t BracketId;
+        uint8_t Rated;
+    };
+
+    constexpr size_t HELLO_SIZE = 4 + 4;
+    constexpr size_t JOIN_SIZE = 8 + 4 + 4 + 1 + 1;
+    constexpr size_t LEAVE_SIZE = 8;
+    constexpr size_t PAIR_SIZE = 8 + 4 + 8 + 4 + 1 + 1;
+
+    inline size_t GetBodySize(uint8_t opcode)
+    {
+        switch (opcode)
+        {
+            case OPCODE_HELLO: return HELLO_SIZE;
+            case OPCODE_JOIN: return JOIN_SIZE;
+            case OPCODE_LEAVE: return LEAVE_SIZE;
+            case OPCODE_PAIR: return PAIR_SIZE;
+            default: return PARSE_ERROR;
+        }
+    }
+
+    // Accumulates messages into a single frame. Call Finish() once before sending, then Reset().
+    class FrameWriter
+    {
+    public:
+        FrameWriter() { Reset(); }
+
+        void Reset()
+        {
+            _buffer.assign(FRAME_HEADER_SIZE, 0);
+            _count = 0;
+        }
+
+        bool Empty() const { return _count == 0; }
+        bool Full() const { return _count == UINT16_MAX || _buffer.size() - FRAME_HEADER_SIZE + 1 + PAIR_SIZE > MAX_FRAME_PAYLOAD; }
+
+        void Add(Hello const& msg)
+        {
+            Begin(OPCODE_HELLO);
+            Put32(msg.Version);
+            Put32(msg.RealmId);
+        }
+
+        void Add(Join const& msg)
+        {
+            Begin(OPCODE_JOIN);
+            Put64(msg.PlayerGuid);
+            Put32(msg.MatchmakerRating);
+            Put32(msg.WaitedMs);
+            Put8(msg.BracketId);
+            Put8(msg.Rated);
+        }
+
+        void Add(Leave const& msg)
+        {
+            Begin(OPCODE_LEAVE);
+            Put64(msg.PlayerGuid);
+        }
+
+        void Add(Pair const& msg)
+        {
+            Begin(OPCODE_PAIR);
+            Put64(msg.FirstGuid);
+            Put32(msg.FirstRealmId);
+            Put64(msg.SecondGuid);
+            Put32(msg.SecondRealmId);
+            Put8(msg.BracketId);
+            Put8(msg.Rated);
+        }
+
+        // Writes the header and returns the finished frame
+        std::vector<uint8_t> const& Finish()
+        {
+            uint32_t payloadSize = uint32_t(_buffer.size() - FRAME_HEADER_SIZE);
+            for (size_t i = 0; i < 4; ++i)
+                _buffer[i] = uint8_t(payloadSize >> (8 * i));
+            _buffer[4] = uint8_t(_count);
+            _buffer[5] = uint8_t(_count >> 8);
+            return _buffer;
+        }
+
+    private:
+        void Begin(uint8_t opcode)
+        {
+            Put8(opcode);
+            ++_count;
+        }
+
+        void Put8(uint8_t value) { _buffer.push_back(value); }
+        void Put32(uint32_t value)
+        {
+            for (size_t i = 0; i < 4; ++i)
+                _buffer.push_back(uint8_t(value >> (8 * i)));
+        }
+        void Put64(uint64_t value)
+        {
+            for (size_t i = 0; i < 8; ++i)
+                _buffer.push_back(uint8_t(value >> (8 * i)));
+        }
+
+        std::vector<uint8_t> _buffer;
+        uint16_t _count;
+    };
+
+    namespace Detail
+    {
+        inline uint32_t Get32(uint8_t const* data)
+        {
+            return uint32_t(data[0]) | uint32_t(data[1]) << 8 | uint32_t(data[2]) << 16 | uint32_t(data[3]) << 24;
+        }
+
+        inline uint64_t Get64(uint8_t const* data)
+        {
+            return uint64_t(Get32(data)) | uint64_t(Get32(data + 4)) << 32;
+        }
+    }
+
+    // Parses every complete frame in [data, data + size) and hands each message to the handler,
+    // which must be callable with Hello, Join, Leave and Pair.
+    // Returns the amount of bytes consumed (incomplete frames are left in the buffer) or PARSE_ERROR.
+    template<class Handler>
+    size_t ParseFrames(uint8_t const* data, size_t size, Handler&& handler)
+    {
+        using namespace Detail;
+
+        size_t consumed = 0;
+        while (size - consumed >= FRAME_HEADER_SIZE)
+        {
+            uint8_t const* frame = data + consumed;
+            uint32_t payloadSize = Get32(frame);
+            uint16_t count = uint16_t(frame[4] | frame[5] << 8);
+            if (payloadSize > MAX_FRAME_PAYLOAD)
+                return PARSE_ERROR;
+            if (size - consumed - FRAME_HEADER_SIZE < payloadSize)
+                break;
+
+            uint8_t const* itr = frame + FRAME_HEADER_SIZE;
+            uint8_t const* end = itr + payloadSize;
+            for (uint16_t i = 0; i < count; ++i)
+            {
+                if (itr == end)
+                    return PARSE_ERROR;
+
+                uint8_t opcode = *itr++;
+                size_t bodySize = GetBodySize(opcode);
+                if (bodySize == PARSE_ERROR || size_t(end - itr) < bodySize)
+                    return PARSE_ERROR;
+
+                switch (opcode)
+                {
+                    case OPCODE_HELLO:
+                        handler(Hello{ Get32(itr), Get32(itr + 4) });
+                        break;
+                    case OPCODE_JOIN:
+                        handler(Join{ Get64(itr), Get32(itr + 8), Get32(itr + 12), itr[16], itr[17] });
+                        break;
+                    case OPCODE_LEAVE:
+                        handler(Leave{ Get64(itr) });
+                        break;
+                    case OPCODE_PAIR:
+                        handler(Pair{ Get64(itr), Get32(itr + 8), Get64(itr + 12), Get32(itr + 20), itr[24], itr[25] });
+                        break;
+                }
+                itr += bodySize;
+            }
+
+            if (itr != end)
+                return PARSE_ERROR;
+
+            consumed += FRAME_HEADER_SIZE + payloadSize;
+        }
+
+        return consumed;
+    }
+}
+
+#endif
@@ -0,0 +1,247 @@
+// This code is licensed under MIT license
+
+#include "SoloArenaLadder.h"
+#include "ArenaTeam.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOLOARENA_SSE2
+#include <emmintrin.h>
+#endif
+
+void SoloArenaLadder::Clear()
+{
+    TeamIds.clear();
+    Captains.clear();
+    Ratings.clear();
+    SeasonGames.clear();
+    SeasonWins.clear();
+    Rows.clear();
+}
+
+void SoloArenaLadder::Reserve(size_t count)
+{
+    TeamIds.reserve(count);
+    Captains.reserve(count);
+    Ratings.reserve(count);
+    SeasonGames.reserve(count);
+    SeasonWins.reserve(count);
+    Rows.reserve(count);
+}
+
+uint32 SoloArenaLadder::Add(ArenaTeam const* team)
+{
+    auto itr = Rows.find(team->GetId());
+    uint32 row = itr != Rows.end() ? itr->second : uint32(TeamIds.size());
+    if (itr == Rows.end())
+    {
+        Rows[team->GetId()] = row;
+        TeamIds.push_back(0);
+        Captains.push_back(0);
+        Ratings.push_back(0);
+        SeasonGames.push_back(0);
+        SeasonWins.push_back(0);
+    }
+
+    ArenaTeamStats const& stats = team->GetStats();
+    TeamIds[row] = team->GetId();
+    Captains[row] = team->GetCaptain().GetCounter();
+    Ratings[row] = stats.Rating;
+    SeasonGames[row] = stats.SeasonGames;
+    SeasonWins[row] = stats.SeasonWins;
+    return row;
+}
+
+// Swaps the last row into the removed one, so row numbers are not stable across removals
+bool SoloArenaLadder::Remove(uint32 teamId)
+{
+    auto itr = Rows.find(teamId);
+    if (itr == Rows.end())
+        return false;
+
+    uint32 row = itr->second;
+    uint32 last = uint32(TeamIds.size() - 1);
+    Rows.erase(itr);
+
+    if (row != last)
+    {
+        TeamIds[row] = TeamIds[last];
+        Captains[row] = Captains[last];
+        Ratings[row] = Ratings[last];
+        SeasonGames[row] = SeasonGames[last];
+        SeasonWins[row] = SeasonWins[last];
+        Rows[TeamIds[row]] = row;
+    }
+
+    TeamIds.pop_back();
+    Captains.pop_back();
+    Ratings.pop_back();
+    SeasonGames.pop_back();
+    SeasonWins.pop_back();
+    return true;
+}
+
+#ifdef SOLOARENA_SSE2
+namespace
+{
+    inline __m128i Load(uint32 const* data) { return _mm_loadu_si128(reinterpret_cast<__m128i const*>(data)); }
+    inline void Store(uint32* data, __m128i value) { _mm_storeu_si128(reinterpret_cast<__m128i*>(data), value); }
+    inline __m128i Select(__m128i mask, __m128i a, __m128i b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+    inline __m128i Max32(__m128i a, __m128i b) { return Select(_mm_cmpgt_epi32(a, b), a, b); }
+    inline __m128i Min32(__m128i a, __m128i b) { return Select(_mm_cmplt_epi32(a, b), a, b); }
+
+    inline size_t HorizontalSum(__m128i value)
+    {
+        alignas(16) int32 lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), value);
+        return size_t(lanes[0]) + size_t(lanes[1]) + size_t(lanes[2]) + size_t(lanes[3]);
+    }
+}
+#endif
+
+namespace SoloArenaKernels
+{
+    void ApplyDecay(uint32* ratings, uint32 const* games, size_t count, uint32 minGames, uint32 points, uint32 floor)
+    {
+        size_t i = 0;
+#ifdef SOLOARENA_SSE2
+        __m128i vMinGames = _mm_set1_epi32(int32(minGames));
+        __m128i vPoints = _mm_set1_epi32(int32(points));
+        __m128i vFloor = _mm_set1_epi32(int32(floor));
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i rating = Load(ratings + i);
+            __m128i inactive = _mm_cmplt_epi32(Load(games + i), vMinGames);
+            // max(min(rating, floor), rating - points) leaves ratings under the floor alone
+            __m128i decayed = Max32(Min32(rating, vFloor), _mm_sub_epi32(rating, vPoints));
+            Store(ratings + i, Select(inactive, decayed, rating));
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            if (games[i] >= minGames || ratings[i] <= floor)
+                continue;
+            ratings[i] = ratings[i] - floor > points ? ratings[i] - points : floor;
+        }
+    }
+
+    void Compress(uint32* ratings, size_t count, uint32 base, float factor)
+    {
+        size_t i = 0;
+#ifdef SOLOARENA_SSE2
+        __m128i vBase = _mm_set1_epi32(int32(base));
+        __m128 vFactor = _mm_set1_ps(factor);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i rating = Load(ratings + i);
+            __m128i above = _mm_cmpgt_epi32(rating, vBase);
+            __m128 excess = _mm_cvtepi32_ps(_mm_sub_epi32(rating, vBase));
+            __m128i compressed = _mm_add_epi32(vBase, _mm_cvttps_epi32(_mm_mul_ps(excess, vFactor)));
+            Store(ratings + i, Select(above, compressed, rating));
+        }
+#endif
+        for (; i < count; ++i)
+            if (ratings[i] > base)
+                ratings[i] = base + uint32(float(ratings[i] - base) * factor);
+    }
+
+    size_t CountAtLeast(uint32 const* ratings, size_t count, uint32 threshold)
+    {
+        size_t result = 0;
+        size_t i = 0;
+#ifdef SOLOARENA_SSE2
+        __m128i vThreshold = _mm_set1_epi32(int32(threshold) - 1);
+        __m128i accumulator = _mm_setzero_si128();
+        for (; i + 4 <= count; i += 4)
+            accumulator = _mm_sub_epi32(accumulator, _mm_cmpgt_epi32(Load(ratings + i), vThreshold)); // true lanes are -1
+        result = HorizontalSum(accumulator);
+#endif
+        for (; i < count; ++i)
+            if (ratings[i] >= threshold)
+                ++result;
+        return result;
+    }
+
+    size_t CountDifferent(uint32 const* a, uint32 const* b, size_t count)
+    {
+        size_t same = 0;
+        size_t i = 0;
+#ifdef SOLOARENA_SSE2
+        __m128i accumulator = _mm_setzero_si128();
+        for (; i + 4 <= count; i += 4)
+            accumulator = _mm_sub_epi32(accumulator, _mm_cmpeq_epi32(Load(a + i), Load(b + i)));
+        same = HorizontalSum(accumulator);
+#endif
+        for (; i < count; ++i)
+            if (a[i] == b[i])
+                ++same;
+        return count - same;
+    }
+
+    uint32 Max(uint32 const* ratings, size_t count)
+    {
+        uint32 result = 0;
+        size_t i = 0;
+#ifdef SOLOARENA_SSE2
+        __m128i vMax = _mm_setzero_si128();
+        for (; i + 4 <= count; i += 4)
+            vMax = Max32(vMax, Load(ratings + i));
+        alignas(16) uint32 lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), vMax);
+        result = std::max({ lanes[0], lanes[1], lanes[2], lanes[3] });
+#endif
+        for (; i < count; ++i)
+            result = std::max(result, ratings[i]);
+        return result;
+    }
+
+    // Binary search over the rating range, every probe is one CountAtLeast pass
+    uint32 FindCutoff(uint32 const* ratings, size_t count, uint32 permille)
+    {
+        if (!count)
+            return 0;
+
+        size_t wanted = std::max<size_t>(1, (size_t(count) * permille + 999) / 1000);
+        uint32 low = 0;
+        uint32 high = Max(ratings, count);
+        while (low < high)
+        {
+            uint32 middle = low + (high - low + 1) / 2;
+            if (CountAtLeast(ratings, count, middle) >= wanted)
+                low = middle;
+            else
+                high = middle - 1;
+        }
+        return low;
+    }
+
+    void AssignTiers(uint32 const* ratings, uint32 const* games, uint8* tiers, size_t count, uint32 const* cutoffs, size_t cutoffCount, uint32 minGames)
+    {
+        size_t i = 0;
+#ifdef SOLOARENA_SSE2
+        __m128i vMinGames = _mm_set1_epi32(int32(minGames) - 1);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i rating = Load(ratings + i);
+            __m128i tier = _mm_setzero_si128();
+            for (size_t c = 0; c < cutoffCount; ++c)
+                tier = _mm_sub_epi32(tier, _mm_cmpgt_epi32(rating, _mm_set1_epi32(int32(cutoffs[c]) - 1)));
+            tier = _mm_and_si128(tier, _mm_cmpgt_epi32(Load(games + i), vMinGames));
+
+            alignas(16) uint32 lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), tier);
+            for (size_t lane = 0; lane < 4; ++lane)
+                tiers[i + lane] = uint8(lanes[lane]);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            uint8 tier = 0;
+            if (games[i] >= minGames)
+                for (size_t c = 0; c < cutoffCount; ++c)
+                    if (ratings[i] >= cutoffs[c])
+                        ++tier;
+            tiers[i] = tier;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+// This code is licensed under MIT license
+
+#ifndef _SOLOARENALADDER_H
+#define _SOLOARENALADDER_H
+
+#include "Define.h"
+#include <unordered_map>
+#include <vector>
+
+class ArenaTeam;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Struct of arrays view of every solo arena team.
+// Row i of every array belongs to the same team, so whole ladder passes only touch the
+// columns they need instead of chasing ArenaTeam pointers across the heap.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SoloArenaLadder
+{
+public:
+    std::vector<uint32> TeamIds;
+    std::vector<uint32> Captains;       // guid counters
+    std::vector<uint32> Ratings;
+    std::vector<uint32> SeasonGames;
+    std::vector<uint32> SeasonWins;
+
+    void Clear();
+    void Reserve(size_t count);
+    uint32 Add(ArenaTeam const* team);
+    bool Remove(uint32 teamId);
+    bool Contains(uint32 teamId) const { return Rows.find(teamId) != Rows.end(); }
+    size_t Size() const { return TeamIds.size(); }
+
+private:
+    std::unordered_map<uint32, uint32> Rows;    // team id -> row
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Whole column kernels used by the season rollover.
+// They use SSE2 when available and assume ratings and game counts fit in an int32.
+////////////////////////////////////////////////////////////////////////////////////////////
+namespace SoloArenaKernels
+{
+    // Inactive rows (games < minGames) lose points, but never drop below floor because of it
+    void ApplyDecay(uint32* ratings, uint32 const* games, size_t count, uint32 minGames, uint32 points, uint32 floor);
+    // Ratings above base are pulled towards it: base + (rating - base) * factor
+    void Compress(uint32* ratings, size_t count, uint32 base, float factor);
+    size_t CountAtLeast(uint32 const* ratings, size_t count, uint32 threshold);
+    size_t CountDifferent(uint32 const* a, uint32 const* b, size_t count);
+    uint32 Max(uint32 const* ratings, size_t count);
+    // Lowest rating reached by the best `permille` of the ratings
+    uint32 FindCutoff(uint32 const* ratings, size_t count, uint32 permille);
+    // tiers[i] = amount of cutoffs reached by rows with at least minGames, cutoffs are sorted best first
+    void AssignTiers(uint32 const* ratings, uint32 const* games, uint8* tiers, size_t count, uint32 const* cutoffs, size_t cutoffCount, uint32 minGames);
+}
+
+struct SoloArenaSeasonReport
+{
+    uint32 Teams = 0;
+    uint32 Decayed = 0;
+    uint32 Compressed = 0;
+    uint32 Written = 0;
+    uint32 Transactions = 0;
+    std::vector<uint32> Cutoffs;        // best first, matching Arena.1v1.Season.RewardCutoffs
+    std::vector<uint32> TierCounts;     // TierCounts[t] = teams that reached exactly t cutoffs
+
+    uint64 LoadMicros = 0;
+    uint64 DecayMicros = 0;
+    uint64 CompressMicros = 0;
+    uint64 CutoffMicros = 0;
+    uint64 TierMicros = 0;
+    uint64 WriteMicros = 0;
+};
+
+#endif
@@ -0,0 +1,74 @@
+// This code is licensed under MIT license
+
+#ifndef _SOLOARENAMATCHHISTORY_H
+#define _SOLOARENAMATCHHISTORY_H
+
+#include "Define.h"
+#include <array>
+
+// How many results are remembered per player, also the amount of rows per player in character_solo_arena_history
+constexpr uint8 SOLO_ARENA_HISTORY_SIZE = 10;
+
+struct SoloArenaMatchResult
+{
+    uint32 Opponent = 0;        // opponent guid counter
+    int16 RatingChange = 0;
+    bool Won = false;
+    bool Rated = false;
+    uint32 Duration = 0;        // seconds
+    uint32 EndTime = 0;         // unix time
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Fixed size ring of a player's most recent 1v1 results.
+// Adding never allocates, the oldest result is overwritten once the ring is full.
+// Unflushed counts the newest results that still have to be written to the database.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SoloArenaMatchHistory
+{
+public:
+    void Add(SoloArenaMatchResult const& result)
+    {
+        Results[Head] = result;
+        Head = (Head + 1) % SOLO_ARENA_HISTORY_SIZE;
+        if (Count < SOLO_ARENA_HISTORY_SIZE)
+            ++Count;
+        if (Unflushed < SOLO_ARENA_HISTORY_SIZE)
+            ++Unflushed;
+    }
+
+    uint8 GetCount() const { return Count; }
+    uint8 GetUnflushed() const { return Unflushed; }
+    void MarkFlushed() { Unflushed = 0; }
+
+    // Ring slot of the nth newest result, this is also the slot it is stored under in the database
+    uint8 GetSlot(uint8 newest) const { return (Head + SOLO_ARENA_HISTORY_SIZE - 1 - newest) % SOLO_ARENA_HISTORY_SIZE; }
+    SoloArenaMatchResult const& GetResult(uint8 newest) const { return Results[GetSlot(newest)]; }
+
+    // Restores a result loaded from the database into its slot, results must be loaded oldest first
+    void Load(uint8 slot, SoloArenaMatchResult const& result)
+    {
+        if (slot >= SOLO_ARENA_HISTORY_SIZE)
+            return;
+
+        Results[slot] = result;
+        Head = (slot + 1) % SOLO_ARENA_HISTORY_SIZE;
+        if (Count < SOLO_ARENA_HISTORY_SIZE)
+            ++Count;
+    }
+
+    template<class F>
+    void ForEachNewestFirst(F&& f) const
+    {
+        for (uint8 i = 0; i < Count; ++i)
+            f(GetResult(i));
+    }
+
+private:
+    std::array<SoloArenaMatchResult, SOLO_ARENA_HISTORY_SIZE> Results = { };
+    uint8 Head = 0;
+    uint8 Count = 0;
+    uint8 Unflushed = 0;
+};
+
+#endif
@@ -0,0 +1,101 @@
+// This code is licensed under MIT license
+
+#ifndef _SOLOARENAMATCHUPS_H
+#define _SOLOARENAMATCHUPS_H
+
+#include "Define.h"
+#include <array>
+#include <vector>
+
+// Three talent tabs for every class id from 1 to 11 in tab order, the last one for players without talents
+constexpr uint8 SOLO_ARENA_MATCHUP_TABS = 34;
+constexpr uint8 SOLO_ARENA_MATCHUP_UNKNOWN_TAB = SOLO_ARENA_MATCHUP_TABS - 1;
+
+// Average matchmaker rating of both players: below 1500, then one band every 300 rating, 2400 and above share the last
+constexpr uint8 SOLO_ARENA_MATCHUP_BANDS = 5;
+constexpr uint32 SOLO_ARENA_MATCHUP_BAND_START = 1500;
+constexpr uint32 SOLO_ARENA_MATCHUP_BAND_WIDTH = 300;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Rated 1v1 results counted by rating band, winner tab and loser tab.
+// The matrix has a fixed size, so recording a result is one increment and never allocates
+// past the first result of a cell since the last flush. Dirty lists the cells that changed
+// since then, they are written with their whole count.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SoloArenaMatchups
+{
+public:
+    static constexpr uint32 CELLS = SOLO_ARENA_MATCHUP_BANDS * SOLO_ARENA_MATCHUP_TABS * SOLO_ARENA_MATCHUP_TABS;
+
+    static uint8 GetBand(uint32 averageRating)
+    {
+        if (averageRating < SOLO_ARENA_MATCHUP_BAND_START)
+            return 0;
+        uint32 band = (averageRating - SOLO_ARENA_MATCHUP_BAND_START) / SOLO_ARENA_MATCHUP_BAND_WIDTH + 1;
+        return uint8(band < SOLO_ARENA_MATCHUP_BANDS ? band : SOLO_ARENA_MATCHUP_BANDS - 1);
+    }
+
+    static uint8 GetTab(uint8 classId, uint32 tabPage)
+    {
+        if (classId == 0 || tabPage >= 3 || (classId - 1) * 3 + tabPage >= SOLO_ARENA_MATCHUP_UNKNOWN_TAB)
+            return SOLO_ARENA_MATCHUP_UNKNOWN_TAB;
+        return uint8((classId - 1) * 3 + tabPage);
+    }
+
+    static uint32 GetCell(uint8 band, uint8 winner, uint8 loser)
+    {
+        return (uint32(band) * SOLO_ARENA_MATCHUP_TABS + winner) * SOLO_ARENA_MATCHUP_TABS + loser;
+    }
+
+    void Record(uint8 band, uint8 winner, uint8 loser)
+    {
+        uint32 cell = GetCell(band, winner, loser);
+        ++Wins[cell];
+        if (!IsDirty[cell])
+        {
+            IsDirty[cell] = true;
+            Dirty.push_back(uint16(cell));
+        }
+    }
+
+    // Restores a count loaded from the database
+    void Load(uint8 band, uint8 winner, uint8 loser, uint32 wins)
+    {
+        if (band < SOLO_ARENA_MATCHUP_BANDS && winner < SOLO_ARENA_MATCHUP_TABS && loser < SOLO_ARENA_MATCHUP_TABS)
+            Wins[GetCell(band, winner, loser)] = wins;
+    }
+
+    uint32 GetWins(uint8 band, uint8 winner, uint8 loser) const { return Wins[GetCell(band, winner, loser)]; }
+
+    uint32 GetWinsInAllBands(uint8 winner, uint8 loser) const
+    {
+        uint32 wins = 0;
+        for (uint8 band = 0; band < SOLO_ARENA_MATCHUP_BANDS; ++band)
+            wins += GetWins(band, winner, loser);
+        return wins;
+    }
+
+    std::vector<uint16> const& GetDirty() const { return Dirty; }
+    uint32 GetWinsOfCell(uint32 cell) const { return Wins[cell]; }
+
+    void MarkFlushed()
+    {
+        for (uint16 cell : Dirty)
+            IsDirty[cell] = false;
+        Dirty.clear();
+    }
+
+    void Clear()
+    {
+        Wins.fill(0);
+        IsDirty.fill(false);
+        Dirty.clear();
+    }
+
+private:
+    std::array<uint32, CELLS> Wins = { };
+    std::array<bool, CELLS> IsDirty = { };
+    std::vector<uint16> Dirty;
+};
+
+#endif
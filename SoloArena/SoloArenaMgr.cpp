@@ -1,18 +1,30 @@
 // This code is licensed under MIT license
 
 #include "SimpleGossip.h"
+#include "SimpleGossipRegistry.h"
 #include "SoloArenaMgr.h"
+#include "Arena.h"
 #include "ArenaTeam.h"
 #include "ArenaTeamMgr.h"
+#include "CharacterCache.h"
+#include "DatabaseEnv.h"
 #include "DBCStores.h" 
 #include "Chat.h"
 #include "Config.h"
 #include "Log.h"
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include "BattlegroundMgr.h"
+#include "BattlegroundQueue.h"
 #include "DisableMgr.h"
+#include "ObjectAccessor.h"
 #include "Player.h"
+#include "WorldPacket.h"
 #include "WorldSession.h"
+#include "World.h"
+#include "GameTime.h"
+#include "Timer.h"
 #include <Globals\ObjectMgr.h>
 
 /// <summary>
@@ -29,45 +41,41 @@ bool SoloArenaMgr::CheckIfPlayerTalentsAndSpellsAreAllowed(Player* player)
     // Check talents
     if (EnableForbiddenTalentTreeBlocking)
     {
-        std::map<uint32, uint8> talentCount;
+        std::map<uint32, uint32> talentCount;
 
-        for (uint8 talentId = 0; talentId < sTalentStore.GetNumRows(); ++talentId)
+        for (uint32 talentId = 0; talentId < sTalentStore.GetNumRows(); ++talentId)
         {
             TalentEntry const* talentInfo = sTalentStore.LookupEntry(talentId);
 
             if (!talentInfo)
                 continue;
 
-            for (uint8 rank = MAX_TALENT_RANK - 1; rank >= 0; --rank)
+            for (int32 rank = MAX_TALENT_RANK - 1; rank >= 0; --rank)
             {
                 if (talentInfo->SpellRank[rank] == 0)
                     continue;
 
-                if (player->HasTalent(talentInfo->SpellRank[rank], player->GetActiveSpec()))
+                if (!player->HasTalent(talentInfo->SpellRank[rank], player->GetActiveSpec()))
+                    continue;
+
+                for (uint32 tree : ForbiddenTalentTrees)
                 {
-                    for (uint8 i = 0; ForbiddenTalentTrees[i] != 0; i++)
+                    if (tree != talentInfo->TabID)
+                        continue;
+
+                    talentCount[tree] += rank + 1;
+
+                    // Check the talent tree limits to see if there's too many, a tree without a limit allows none
+                    auto limit = ForbiddenTalentTreeLimits.find(tree);
+                    if (talentCount[tree] > (limit != ForbiddenTalentTreeLimits.end() ? limit->second : 0))
                     {
-                        if (ForbiddenTalentTrees[i] == talentInfo->TabID)
-                        {
-                            if (talentCount.find(ForbiddenTalentTrees[i]) == talentCount.end())
-                            {
-                                // No entry yet, start one
-                                talentCount[ForbiddenTalentTrees[i]] = rank + 1;
-                            }
-                            else
-                            {
-                                // There's an entry, add to it
-                                talentCount[ForbiddenTalentTrees[i]] = talentCount[ForbiddenTalentTrees[i]] + rank + 1;
-                            }
-                            // Check the talent tree limits to see if there's too many
-                            if (talentCount[ForbiddenTalentTrees[i]] > ForbiddenTalentTreeLimits[talentCount[ForbiddenTalentTrees[i]]])
-                            {
-                                ChatHandler(player->GetSession()).SendSysMessage("You can't join because you have invested too many points in a forbidden talent tree. Please edit your talents.");
-                                return false;
-                            }
-                        }
+                        ChatHandler(player->GetSession()).SendSysMessage("You can't join because you have invested too many points in a forbidden talent tree. Please edit your talents.");
+                        return false;
                     }
                 }
+
+                // Only the highest learned rank counts
+                break;
             }
         }
     }
@@ -115,11 +123,62 @@ void SoloArenaMgr::InitializeSoloArenaMgr()
     ForbiddenTalentTreeLimits = MapForbiddenTalentTreeLimits(ForbiddenTalentTrees, forbiddenTalentTreeLimitsUnmapped);
     ForbiddenSpells = ParseConfigStringIntoUInt32Array(strForbiddenSpells);
 
-    if (Gossip)
+    UseBroker = sConfigMgr->GetBoolDefault("Arena.1v1.Broker.Enable", false);
+    if (UseBroker)
+    {
+        TC_LOG_WARN("arena.loading", "Arena.1v1.Broker.Enable: the Solo Arena broker only pairs players of the same realm, it doesn't pool the queues of several realms yet.");
+    }
+    BrokerAddress = sConfigMgr->GetStringDefault("Arena.1v1.Broker.Address", "unix:/tmp/soloarena-broker.sock");
+    BrokerReconnectInterval = sConfigMgr->GetIntDefault("Arena.1v1.Broker.ReconnectInterval", 10) * IN_MILLISECONDS;
+    MatchmakingThreads = sConfigMgr->GetIntDefault("Arena.1v1.Matchmaking.Threads", 0);
+    MatchmakingInterval = sConfigMgr->GetIntDefault("Arena.1v1.Matchmaking.Interval", 1000);
+    MatchStartsPerUpdate = sConfigMgr->GetIntDefault("Arena.1v1.Matchmaking.StartsPerUpdate", 4);
+    MatchmakingBudget = sConfigMgr->GetIntDefault("Arena.1v1.Matchmaking.Budget", 2000);
+    QueueStatusInterval = sConfigMgr->GetIntDefault("Arena.1v1.Queue.StatusInterval", 5) * IN_MILLISECONDS;
+    QueueStatusChat = sConfigMgr->GetBoolDefault("Arena.1v1.Queue.StatusChat", false);
+    HistoryFlushInterval = sConfigMgr->GetIntDefault("Arena.1v1.History.FlushInterval", 300) * IN_MILLISECONDS;
+    HistoryFlushTimer = HistoryFlushInterval;
+    LiveMatchesShown = std::min<uint32>(sConfigMgr->GetIntDefault("Arena.1v1.LiveMatches.Shown", 5), SimpleGossipOptionGenerator::MAX_PAGE_SIZE);
+    SnapshotFile = sConfigMgr->GetStringDefault("Arena.1v1.Snapshot.File", "soloarena.snapshot");
+    SnapshotInterval = sConfigMgr->GetIntDefault("Arena.1v1.Snapshot.Interval", 300) * IN_MILLISECONDS;
+    SnapshotTimer = SnapshotInterval;
+    SnapshotRequeueWindow = sConfigMgr->GetIntDefault("Arena.1v1.Snapshot.RequeueWindow", 300);
+
+    SeasonDecayMinGames = sConfigMgr->GetIntDefault("Arena.1v1.Season.DecayMinGames", 10);
+    SeasonDecayPoints = sConfigMgr->GetIntDefault("Arena.1v1.Season.DecayPoints", 100);
+    SeasonDecayFloor = sConfigMgr->GetIntDefault("Arena.1v1.Season.DecayFloor", 1500);
+    SeasonCompressBase = sConfigMgr->GetIntDefault("Arena.1v1.Season.CompressBase", 1500);
+    SeasonCompressFactor = sConfigMgr->GetFloatDefault("Arena.1v1.Season.CompressFactor", 0.5f);
+    SeasonRewardCutoffs = ParseConfigStringIntoUInt32Array(sConfigMgr->GetStringDefault("Arena.1v1.Season.RewardCutoffs", "5, 30, 100, 350"));
+    std::sort(SeasonRewardCutoffs.begin(), SeasonRewardCutoffs.end());
+    SeasonRewardMinGames = sConfigMgr->GetIntDefault("Arena.1v1.Season.RewardMinGames", 10);
+    SeasonResetGames = sConfigMgr->GetBoolDefault("Arena.1v1.Season.ResetGames", true);
+    SeasonBatchSize = std::max(1, sConfigMgr->GetIntDefault("Arena.1v1.Season.BatchSize", 500));
+
+    if (!MatchHistoriesLoaded)
+    {
+        LoadMatchHistories();
+    }
+    if (!MatchupsLoaded)
+    {
+        LoadMatchups();
+    }
+
+    if (Matchmaker.GetThreadCount() != MatchmakingThreads)
     {
-        delete Gossip;
+        Matchmaker.Start(MatchmakingThreads);
     }
-    Gossip = new SimpleGossip();
+
+    // Reloading may change the address, the queue is resynced once the connection is back
+    Broker.Disconnect();
+    if (UseBroker)
+    {
+        ConnectToBroker();
+    }
+
+    // Reloading reuses the gossip, Clear frees the old menu graph and its ids stop resolving
+    Gossip = sSimpleGossipRegistry->Register("custom_npc_SoloArena");
+    Gossip->Clear();
 
     SetupGossip(Gossip);
 }
@@ -311,329 +370,1851 @@ bool SoloArenaMgr::JoinArenaQueue(Player* player, bool rated)
         }
     }
 
+    // The rated flag lives on the queue entry only, the arena template is shared by every queue and stays untouched
     BattlegroundQueue& bgQueue = sBattlegroundMgr->GetBattlegroundQueue(bgQueueTypeId);
-    bg->SetRated(rated);
-
     GroupQueueInfo* ginfo = bgQueue.AddGroup(player, NULL, bgTypeId, bracketEntry, ARENA_TYPE_1v1, rated, false, arenaRating, matchmakerRating, arenaTeamId);
     uint32 avgTime = bgQueue.GetAverageQueueWaitTime(ginfo, bracketEntry->GetBracketId());
     uint32 queueSlot = player->AddBattlegroundQueueId(bgQueueTypeId);
 
-    WorldPacket data;
-    // send status packet (in queue)
-    sBattlegroundMgr->BuildBattlegroundStatusPacket(&data, bg, queueSlot, STATUS_WAIT_QUEUE, avgTime, 0, ARENA_TYPE_1v1, 0);
-    player->GetSession()->SendPacket(&data);
+    SendQueueStatus(player, queueSlot, avgTime, rated);
 
-    sBattlegroundMgr->ScheduleQueueUpdate(matchmakerRating, ARENA_TYPE_1v1, bgQueueTypeId, bgTypeId, bracketEntry->GetBracketId());
+    SoloArenaQueueEntry entry;
+    entry.Guid = player->GetGUID().GetCounter();
+    entry.MatchmakerRating = matchmakerRating;
+    entry.JoinTime = ginfo->JoinTime;
+    entry.Rated = rated;
+    Queues[bracketEntry->GetBracketId()].Add(entry);
+    sSimpleGossipState->Bump(player->GetGUID(), SIMPLEGOSSIP_STATE_QUEUE);
+
+    if (HandlesMatchmaking())
+    {
+        Broker.QueueJoin(entry.Guid, matchmakerRating, 0, bracketEntry->GetBracketId(), rated);
+    }
 
     return true;
 }
 
-void ocLeaveQueue(Player* player, SimpleGossipOptionIconText* option) { sSoloArenaMgr->LeaveQueue(player); }
-bool SoloArenaMgr::LeaveQueue(Player* player)
+// Same SMSG_BATTLEFIELD_STATUS as BattlegroundMgr::BuildBattlegroundStatusPacket, but the rated flag comes from the queue entry instead of the arena template.
+void SoloArenaMgr::SendQueueStatus(Player* player, uint32 queueSlot, uint32 avgTime, bool rated, uint32 timeInQueue)
 {
-    WorldPacket Data;
-    Data << (uint8)0x1 << (uint8)0x0 << (uint32)BATTLEGROUND_AA << (uint16)0x0 << (uint8)0x0;
-    player->GetSession()->HandleBattleFieldPortOpcode(Data);
-    return true;
+    WorldPacket data(SMSG_BATTLEFIELD_STATUS, 4 + 8 + 1 + 1 + 4 + 1 + 4 + 4 + 4);
+    data << uint32(queueSlot);
+    data << uint8(ARENA_TYPE_1v1);
+    data << uint8(0xC);
+    data << uint32(BATTLEGROUND_AA);
+    data << uint16(0x1F90);
+    data << uint8(0);
+    data << uint8(0);
+    data << uint32(0);                  // client instance id
+    data << uint8(rated ? 1 : 0);
+    data << uint32(STATUS_WAIT_QUEUE);
+    data << uint32(avgTime);
+    data << uint32(timeInQueue);
+    player->GetSession()->SendPacket(&data);
 }
 
-void ocRegisterForRated_Replace2v2(Player* player, bool success, SimpleGossipOptionIconTextPopup* option) { if (success) sSoloArenaMgr->RegisterForRated(player, FIRST_SLOT, true); }
-void ocRegisterForRated_Replace3v3(Player* player, bool success, SimpleGossipOptionIconTextPopup* option) { if (success) sSoloArenaMgr->RegisterForRated(player, SECOND_SLOT, true); }
-void ocRegisterForRated_Replace5v5(Player* player, bool success, SimpleGossipOptionIconTextPopup* option) { if (success) sSoloArenaMgr->RegisterForRated(player, THIRD_SLOT, true); }
-bool SoloArenaMgr::RegisterForRated(Player* player, ArenaTeamSlot replace, bool chatWarnings)
+// One pass over every bracket per interval. Only players whose place or estimated wait changed get a new status,
+// so nobody has to reopen the NPC or queue again to see where they stand. The chat line is opt in, it would reach most of a busy queue every time.
+void SoloArenaMgr::PushQueueStatus(uint32 diff)
 {
-    ArenaTeam* currentSoloTeam = GetSoloArenaTeam(player);
-
-    if (currentSoloTeam != nullptr)
+    if (!QueueStatusInterval)
     {
-        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("You are already registered for a Solo Arena Team.");
-        return false;
+        return;
     }
-
-    ArenaTeam* slot = sArenaTeamMgr->GetArenaTeamById(player->GetArenaTeamId(replace));
-    if (slot != nullptr)
+    if (QueueStatusTimer > diff)
     {
-        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("You cannot register for Solo Arena Rated in that slot because you are already registered for an Arena Team in it.");
-        return false;
+        QueueStatusTimer -= diff;
+        return;
     }
+    QueueStatusTimer = QueueStatusInterval;
 
-    ArenaTeam* arenaTeam = new ArenaTeam();
-    auto arenaTeamName = GetSoloArenaTeamNameForPlayer(player->GetName());
-
-    ArenaTeamType type = FIVE_VS_FIVE;
-    switch (replace)
+    Battleground* bgTemplate = sBattlegroundMgr->GetBattlegroundTemplate(BATTLEGROUND_AA);
+    if (!bgTemplate)
     {
-    case FIRST_SLOT: type = TWO_VS_TWO; break;
-    case SECOND_SLOT: type = THREE_VS_THREE; break;
-    case THIRD_SLOT: type = FIVE_VS_FIVE; break;
+        return;
     }
 
-    if (!arenaTeam->Create(player->GetGUID(), type, arenaTeamName, BANNER_1, BANNER_2, BANNER_3, BANNER_4, BANNER_5))
+    uint32 now = GameTime::GetGameTimeMS();
+    for (uint32 bracket = BG_BRACKET_ID_FIRST; bracket < MAX_BATTLEGROUND_BRACKETS; ++bracket)
     {
-        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("Failed to create the Solo Arena Rated Team for some reason.");
-        delete arenaTeam;
-        return false;
-    }
+        QueueStatusChanges.clear();
+        Queues[bracket].CollectStatusChanges(now, QueueStatusChanges);
+        if (QueueStatusChanges.empty())
+        {
+            continue;
+        }
 
-    // Register arena team
-    sArenaTeamMgr->AddArenaTeam(arenaTeam);
+        PvPDifficultyEntry const* bracketEntry = GetBattlegroundBracketById(bgTemplate->GetMapId(), BattlegroundBracketId(bracket));
+        for (SoloArenaQueueStatus const& status : QueueStatusChanges)
+        {
+            Player* player = ObjectAccessor::FindConnectedPlayer(ObjectGuid::Create<HighGuid::Player>(status.Guid));
+            if (!player)
+            {
+                continue;
+            }
 
-    arenaTeam->AddMember(player->GetGUID());
-    arenaTeam->SaveToDB();
+            uint32 queueSlot = player->GetBattlegroundQueueIndex(BATTLEGROUND_QUEUE_1v1);
+            if (queueSlot >= PLAYER_MAX_BATTLEGROUND_QUEUES)
+            {
+                continue;
+            }
 
-    if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("You are now registered for Solo Arena Rated.");
+            SendQueueStatus(player, queueSlot, status.EstimatedWait, status.Rated, status.TimeInQueue);
+            if (!QueueStatusChat)
+            {
+                continue;
+            }
 
-    return true;
+            if (status.EstimatedWait)
+            {
+                ChatHandler(player->GetSession()).PSendSysMessage("Solo Arena %s queue: you are %u of %u in the level %u-%u bracket, estimated wait %u min.",
+                    status.Rated ? "Rated" : "Skirmish", status.Position, status.Waiting,
+                    bracketEntry ? uint32(bracketEntry->MinLevel) : 0, bracketEntry ? uint32(bracketEntry->MaxLevel) : 0, status.EstimatedWait / MINUTE / IN_MILLISECONDS);
+            }
+            else
+            {
+                ChatHandler(player->GetSession()).PSendSysMessage("Solo Arena %s queue: you are %u of %u in the level %u-%u bracket.",
+                    status.Rated ? "Rated" : "Skirmish", status.Position, status.Waiting,
+                    bracketEntry ? uint32(bracketEntry->MinLevel) : 0, bracketEntry ? uint32(bracketEntry->MaxLevel) : 0);
+            }
+        }
+    }
 }
 
-void ocUnregisterFromRated(Player* player, bool success, SimpleGossipOptionIconTextPopup* option) { if (success) sSoloArenaMgr->UnregisterFromRated(player, true); }
-bool SoloArenaMgr::UnregisterFromRated(Player* player, bool chatWarnings)
+void ocLeaveQueue(Player* player, SimpleGossipOptionIconText* option) { sSoloArenaMgr->LeaveQueue(player); }
+bool SoloArenaMgr::LeaveQueue(Player* player)
 {
-    ArenaTeam* arenaTeam = GetSoloArenaTeam(player);
+    WorldPacket Data;
+    Data << (uint8)0x1 << (uint8)0x0 << (uint32)BATTLEGROUND_AA << (uint16)0x0 << (uint8)0x0;
+    player->GetSession()->HandleBattleFieldPortOpcode(Data);
 
-    if (!arenaTeam)
+    for (SoloArenaQueueShard& queue : Queues)
     {
-        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("You are not registered for Solo Arena Rated, so you cannot unregister.");
-        return false;
+        queue.Remove(player->GetGUID().GetCounter());
     }
+    sSimpleGossipState->Bump(player->GetGUID(), SIMPLEGOSSIP_STATE_QUEUE);
 
-    arenaTeam->Disband();
-
-    if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("Unregistered from Solo Arena Rated.");
-
+    if (HandlesMatchmaking())
+    {
+        Broker.QueueLeave(player->GetGUID().GetCounter());
+    }
     return true;
 }
 
-bool ocdRegisterdAndNotInQueueP(Player* player, SimpleGossipPart* part)
-{
-    return ocdIsPlayerRegisteredP(player, part) && ocdIsNotInQueueForSoloArenaP(player, part);
-}
-bool ocdRegisterdAndNotInQueueO(Player* player, SimpleGossipOption* option)
+// When the broker is connected it decides the 1v1 pairs, otherwise the local matchmaking passes do.
+bool SoloArenaMgr::HandlesMatchmaking()
 {
-    return ocdIsPlayerRegisteredO(player, option) && ocdIsNotInQueueForSoloArenaO(player, option);
+    return UseBroker && Broker.IsConnected();
 }
-void ocSwapRatedReplacement_Replace2v2(Player* player, SimpleGossipOptionIconText* option) { sSoloArenaMgr->SwapRatedReplacement(player, FIRST_SLOT, true); }
-void ocSwapRatedReplacement_Replace3v3(Player* player, SimpleGossipOptionIconText* option) { sSoloArenaMgr->SwapRatedReplacement(player, SECOND_SLOT, true); }
-void ocSwapRatedReplacement_Replace5v5(Player* player, SimpleGossipOptionIconText* option) { sSoloArenaMgr->SwapRatedReplacement(player, THIRD_SLOT, true); }
-bool SoloArenaMgr::SwapRatedReplacement(Player* player, ArenaTeamSlot replace, bool chatWarnings)
+
+void SoloArenaMgr::Update(uint32 diff)
 {
-    ArenaTeam* arenaTeam;
-    arenaTeam = GetSoloArenaTeam(player);
+    UpdateBroker(diff);
+    UpdateMatchmaking(diff);
+    StartPendingMatches();
+    PushQueueStatus(diff);
 
-    if (!arenaTeam)
+    if (HistoryFlushTimer <= diff)
     {
-        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("You are not registered for Solo Arena Rated, so you cannot swap your Arena Team's position.");
-        return false;
+        FlushMatchHistories(false);
+        FlushMatchups(false);
+        HistoryFlushTimer = HistoryFlushInterval;
     }
-
-    ArenaTeam* slot;
-    slot = sArenaTeamMgr->GetArenaTeamById(player->GetArenaTeamId(replace));
-    if (slot != nullptr)
+    else
     {
-        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("You cannot swap your Solo Arena Rated Team to a position that's already occupied with an Arena Team.");
-        return false;
+        HistoryFlushTimer -= diff;
     }
 
-    ArenaTeamType type = FIVE_VS_FIVE;
-    switch (replace)
+    if (SnapshotInterval && !SnapshotFile.empty())
     {
-    case FIRST_SLOT: type = TWO_VS_TWO; break;
-    case SECOND_SLOT: type = THREE_VS_THREE; break;
-    case THIRD_SLOT: type = FIVE_VS_FIVE; break;
+        if (SnapshotTimer <= diff)
+        {
+            WriteSnapshot();
+            SnapshotTimer = SnapshotInterval;
+        }
+        else
+        {
+            SnapshotTimer -= diff;
+        }
     }
+}
 
-    std::string playerName = player->GetName();
-    std::string teamName = arenaTeam->GetName();
-    ObjectGuid playerGuid = player->GetGUID();
-    ArenaTeamMember* playerMemberPtr;
-    playerMemberPtr = arenaTeam->GetMember(playerGuid);
+void SoloArenaMgr::UpdateBroker(uint32 diff)
+{
+    if (!UseBroker)
+    {
+        return;
+    }
 
-    if (!playerMemberPtr)
+    if (Broker.IsConnecting())
     {
-        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("Something went wrong trying to find you in your own team! Tell the devs.");
-        return false;
+        if (!Broker.UpdateConnecting())
+        {
+            BrokerReconnectTimer = BrokerReconnectInterval;
+        }
+        else if (Broker.IsConnected())
+        {
+            ResyncBroker();
+        }
+        return;
     }
 
-    ArenaTeamMember playerMember = *playerMemberPtr;
-    ArenaTeamStats arenaTeamStats = arenaTeam->GetStats();
+    if (!Broker.IsConnected())
+    {
+        if (BrokerReconnectTimer > diff)
+        {
+            BrokerReconnectTimer -= diff;
+            return;
+        }
 
-    UnregisterFromRated(player, false);
+        BrokerReconnectTimer = BrokerReconnectInterval;
+        ConnectToBroker();
+        return;
+    }
 
-    ArenaTeam* arenaTeam2;
-    arenaTeam2 = new ArenaTeam();
+    if (!Broker.Update([this](SoloArenaBroker::Pair const& pair) { HandleBrokerPair(pair); }))
+    {
+        TC_LOG_ERROR("bg.arena", "SoloArenaMgr: lost the queue broker, falling back to local 1v1 matchmaking.");
+        BrokerReconnectTimer = BrokerReconnectInterval;
+    }
+}
 
-    uint8 c = 0;
-    do {
-        if (!arenaTeam2->Create(playerGuid, type, teamName, 4283124816, 45, 4294242303, 5, 4294705149))
+// Prunes entries that left the core queue behind our back, then matches every bracket, in parallel when there are matchmaking threads.
+// The passes only produce pairs, starting the matches stays on the world thread. Passes that ran out of MatchmakingBudget
+// are resumed every world update until they are done, without waiting for the next interval.
+void SoloArenaMgr::UpdateMatchmaking(uint32 diff)
+{
+    if (MatchmakingTimer > diff)
+    {
+        MatchmakingTimer -= diff;
+        if (MatchmakingPassesRunning && !HandlesMatchmaking())
         {
-            c++;
+            RunMatchmaking(true);
         }
-        else {
-            break;
+        return;
+    }
+    MatchmakingTimer = MatchmakingInterval;
+
+    for (SoloArenaQueueShard& queue : Queues)
+    {
+        queue.RemoveIf([this](SoloArenaQueueEntry const& entry)
+        {
+            ObjectGuid guid = ObjectGuid::Create<HighGuid::Player>(entry.Guid);
+            if (GetQueuedSoloGroup(guid))
+            {
+                return false;
+            }
+            sSimpleGossipState->Bump(guid, SIMPLEGOSSIP_STATE_QUEUE);
+
+            // Left through the client UI, the broker would otherwise keep pairing them
+            if (HandlesMatchmaking())
+            {
+                Broker.QueueLeave(entry.Guid);
+            }
+            return true;
+        });
+    }
+
+    // Invited players keep their 1v1 queue slot until they enter the arena or decline, neither of which reaches us
+    InvitedPlayers.erase(std::remove_if(InvitedPlayers.begin(), InvitedPlayers.end(), [](ObjectGuid guid)
+    {
+        Player* player = ObjectAccessor::FindConnectedPlayer(guid);
+        if (player && player->InBattlegroundQueueForBattlegroundQueueType(BATTLEGROUND_QUEUE_1v1))
+        {
+            return false;
         }
-    } while (c < 10);
+        sSimpleGossipState->Bump(guid, SIMPLEGOSSIP_STATE_QUEUE);
+        return true;
+    }), InvitedPlayers.end());
 
-    if (!arenaTeam2)
+    if (HandlesMatchmaking())
     {
-        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("Failed to swap your Solo Arena Rated Team, also it was deleted, get fucked.");
-        delete arenaTeam2;
-        return false;
+        return;
     }
 
-    // Register arena team
-    sArenaTeamMgr->AddArenaTeam(arenaTeam2);
+    RunMatchmaking(false);
+}
 
-    arenaTeam2->AddMember(playerGuid);
-    arenaTeam2->SetStats(arenaTeamStats);
-    ArenaTeamMember* playerMember2;
-    playerMember2 = arenaTeam2->GetMember(playerName);
-    playerMember2->PersonalRating = playerMember.PersonalRating;
-    playerMember2->SeasonGames = playerMember.SeasonGames;
-    playerMember2->SeasonWins = playerMember.SeasonWins;
-    playerMember2->WeekGames = playerMember.WeekGames;
-    playerMember2->WeekWins = playerMember.WeekWins;
+// Brackets whose pass is still suspended keep it, resumeOnly doesn't start new passes in the others
+void SoloArenaMgr::RunMatchmaking(bool resumeOnly)
+{
+    SoloArenaMatchmakingSettings settings;
+    settings.MaxRatingDifference = sBattlegroundMgr->GetMaxRatingDifference();
+    settings.RatingDiscardTime = sBattlegroundMgr->GetRatingDiscardTimer();
+    settings.BudgetMicros = MatchmakingBudget;
+    Matchmaker.Run(Queues, MAX_BATTLEGROUND_BRACKETS, GameTime::GetGameTimeMS(), settings, resumeOnly);
+
+    // Paired players leave the shards right away, so later passes can't pair them again while they wait for their start
+    MatchmakingPassesRunning = false;
+    for (uint32 bracket = BG_BRACKET_ID_FIRST; bracket < MAX_BATTLEGROUND_BRACKETS; ++bracket)
+    {
+        PairedStarts.clear();
+        Queues[bracket].TakePairs(PairedStarts);
+        for (SoloArenaPendingStart& start : PairedStarts)
+        {
+            start.Bracket = bracket;
+            StartScheduler.Add(start);
+        }
+        MatchmakingPassesRunning |= Queues[bracket].IsPassRunning();
+    }
+}
 
-    arenaTeam->SaveToDB();
+// Starts the waiting pairs in the scheduler's order, at most MatchStartsPerUpdate arenas per world update (0 starts all of them).
+// Pairs one of whose players stopped waiting meanwhile cost nothing, the other player gets their place in the queue back.
+// A player who left and joined the other queue type or bracket since the pairing isn't waiting for that pair anymore either.
+void SoloArenaMgr::StartPendingMatches()
+{
+    StartScheduler.EndPass(GameTime::GetGameTimeMS());
 
-    if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("Your Solo Arena Rated Team has had its position swapped.");
+    BattlegroundQueue& bgQueue = sBattlegroundMgr->GetBattlegroundQueue(BATTLEGROUND_QUEUE_1v1);
+    auto getWaitingGroup = [&](SoloArenaPendingStart const& start, SoloArenaQueueEntry const& entry) -> GroupQueueInfo*
+    {
+        GroupQueueInfo* ginfo = GetQueuedSoloGroup(ObjectGuid::Create<HighGuid::Player>(entry.Guid));
+        if (!ginfo || ginfo->IsRated != start.Rated)
+        {
+            return nullptr;
+        }
 
-    return true;
+        uint32 index = (ginfo->IsRated ? BG_QUEUE_PREMADE_ALLIANCE : BG_QUEUE_NORMAL_ALLIANCE) + (ginfo->Team == HORDE ? 1 : 0);
+        BattlegroundQueue::GroupsQueueType const& groups = bgQueue.m_QueuedGroups[start.Bracket][index];
+        if (std::find(groups.begin(), groups.end(), ginfo) == groups.end())
+        {
+            return nullptr;
+        }
+        return ginfo;
+    };
+
+    uint32 started = 0;
+    SoloArenaPendingStart start;
+    while ((!MatchStartsPerUpdate || started < MatchStartsPerUpdate) && StartScheduler.Pop(start))
+    {
+        GroupQueueInfo* first = getWaitingGroup(start, start.First);
+        GroupQueueInfo* second = getWaitingGroup(start, start.Second);
+        if (first && second && first != second)
+        {
+            ++started;
+            if (StartSoloMatch(first, second, BattlegroundBracketId(start.Bracket), start.Rated))
+            {
+                continue;
+            }
+        }
+
+        RequeueUnstarted(start, first, second);
+    }
 }
 
-std::string getCaptainName(ArenaTeam* at)
+void SoloArenaMgr::RequeueUnstarted(SoloArenaPendingStart const& start, GroupQueueInfo* first, GroupQueueInfo* second)
 {
-    if (!at)
+    uint32 now = GameTime::GetGameTimeMS();
+    SoloArenaQueueShard& queue = Queues[start.Bracket];
+    std::pair<SoloArenaQueueEntry const*, GroupQueueInfo*> sides[PVP_TEAMS_COUNT] = { { &start.First, first }, { &start.Second, second } };
+    for (auto const& [entry, ginfo] : sides)
     {
-        return "";
+        if (!ginfo)
+        {
+            continue;
+        }
+
+        queue.Add(*entry);
+        queue.Rejoin(entry->Guid, entry->JoinTime, now);
+
+        // The broker forgot both players when it paired them
+        if (HandlesMatchmaking())
+        {
+            Broker.QueueJoin(entry->Guid, entry->MatchmakerRating, GetMSTimeDiff(entry->JoinTime, now), start.Bracket, entry->Rated);
+        }
     }
-    return at->GetMember(at->GetCaptain())->Name;
 }
-bool sortRatedArenaTeams(ArenaTeam* a, ArenaTeam* b)
+
+void SoloArenaMgr::Shutdown()
 {
-    return a->GetRating() > b->GetRating();
+    Matchmaker.Stop();
+    Broker.Disconnect();
+    FlushMatchHistories(true);
+    FlushMatchups(true);
+    if (!SnapshotFile.empty())
+    {
+        WriteSnapshot();
+    }
 }
-bool sortRatedArenaTeamsReverse(ArenaTeam* a, ArenaTeam* b)
+
+// Starts connecting to the broker, UpdateBroker finishes it. Local matchmaking goes on until the connection is up.
+void SoloArenaMgr::ConnectToBroker()
 {
-    return a->GetRating() < b->GetRating();
+    if (!Broker.Connect(BrokerAddress, realm.Id.Realm))
+    {
+        BrokerReconnectTimer = BrokerReconnectInterval;
+    }
 }
-void ocDisplayRatedStatistics(Player* player, SimpleGossipOptionIconText* option) { sSoloArenaMgr->DisplayRatedStatistics(player); }
-bool SoloArenaMgr::DisplayRatedStatistics(Player* player)
-{
-    ArenaTeam* at;
-    at = GetSoloArenaTeam(player);
 
-    if (!at)
+// Sends the broker every player currently waiting in the local 1v1 queue.
+void SoloArenaMgr::ResyncBroker()
+{
+    for (uint32 bracket = BG_BRACKET_ID_FIRST; bracket < MAX_BATTLEGROUND_BRACKETS; ++bracket)
+    {
+        for (SoloArenaQueueEntry const& entry : Queues[bracket].GetEntries())
+        {
+            Broker.QueueJoin(entry.Guid, entry.MatchmakerRating, GetMSTimeDiff(entry.JoinTime, GameTime::GetGameTimeMS()), bracket, entry.Rated);
+        }
+    }
+}
+
+void SoloArenaMgr::HandleBrokerPair(SoloArenaBroker::Pair const& pair)
+{
+    uint32 realmId = realm.Id.Realm;
+    GroupQueueInfo* first = nullptr;
+    GroupQueueInfo* second = nullptr;
+
+    if (pair.FirstRealmId == realmId)
+    {
+        first = GetQueuedSoloGroup(ObjectGuid::Create<HighGuid::Player>(ObjectGuid::LowType(pair.FirstGuid)));
+    }
+    if (pair.SecondRealmId == realmId)
+    {
+        second = GetQueuedSoloGroup(ObjectGuid::Create<HighGuid::Player>(ObjectGuid::LowType(pair.SecondGuid)));
+    }
+
+    if (first && second && first != second && pair.BracketId < MAX_BATTLEGROUND_BRACKETS)
+    {
+        SoloArenaPendingStart start;
+        start.Bracket = pair.BracketId;
+        start.Rated = pair.Rated != 0;
+
+        std::pair<SoloArenaQueueEntry*, GroupQueueInfo*> sides[PVP_TEAMS_COUNT] = { { &start.First, first }, { &start.Second, second } };
+        for (auto const& [entry, ginfo] : sides)
+        {
+            uint32 guid = ginfo->Players.begin()->first.GetCounter();
+            if (!Queues[pair.BracketId].Take(guid, *entry))
+            {
+                entry->Guid = guid;
+                entry->MatchmakerRating = ginfo->ArenaMatchmakerRating;
+                entry->JoinTime = ginfo->JoinTime;
+                entry->Rated = ginfo->IsRated;
+            }
+        }
+
+        StartScheduler.Add(start);
+        return;
+    }
+
+    // The broker forgot both players when it paired them, put back whoever is still waiting here
+    for (GroupQueueInfo* ginfo : { first, second })
+    {
+        if (!ginfo)
+        {
+            continue;
+        }
+
+        for (auto const& [guid, playerInfo] : ginfo->Players)
+        {
+            Broker.QueueJoin(guid.GetCounter(), ginfo->ArenaMatchmakerRating, GetMSTimeDiff(ginfo->JoinTime, GameTime::GetGameTimeMS()), pair.BracketId, ginfo->IsRated);
+        }
+    }
+}
+
+// Returns the queue entry of a player still waiting in the 1v1 queue, invited players are not waiting anymore.
+GroupQueueInfo* SoloArenaMgr::GetQueuedSoloGroup(ObjectGuid guid)
+{
+    BattlegroundQueue& bgQueue = sBattlegroundMgr->GetBattlegroundQueue(BATTLEGROUND_QUEUE_1v1);
+    auto itr = bgQueue.m_QueuedPlayers.find(guid);
+    if (itr == bgQueue.m_QueuedPlayers.end() || !itr->second.GroupInfo || itr->second.GroupInfo->IsInvitedToBGInstanceGUID)
+    {
+        return nullptr;
+    }
+    return itr->second.GroupInfo;
+}
+
+// The core keeps queued groups in per faction lists, so a group has to move along when its side changes.
+void SoloArenaMgr::MoveSoloGroupToTeam(BattlegroundQueue& bgQueue, GroupQueueInfo* ginfo, BattlegroundBracketId bracketId, uint32 team)
+{
+    if (ginfo->Team == team)
+    {
+        return;
+    }
+
+    uint32 index = ginfo->IsRated ? BG_QUEUE_PREMADE_ALLIANCE : BG_QUEUE_NORMAL_ALLIANCE;
+    BattlegroundQueue::GroupsQueueType& from = bgQueue.m_QueuedGroups[bracketId][index + (ginfo->Team == HORDE ? 1 : 0)];
+    BattlegroundQueue::GroupsQueueType& to = bgQueue.m_QueuedGroups[bracketId][index + (team == HORDE ? 1 : 0)];
+
+    auto itr = std::find(from.begin(), from.end(), ginfo);
+    if (itr != from.end())
+    {
+        to.splice(to.begin(), from, itr);
+    }
+    ginfo->Team = team;
+}
+
+// Creates a 1v1 arena for two waiting queue entries and invites both of them, mirroring what the core does for rated arenas.
+// Factions don't matter in 1v1, the first player always takes the alliance side and the second one the horde side.
+bool SoloArenaMgr::StartSoloMatch(GroupQueueInfo* first, GroupQueueInfo* second, BattlegroundBracketId bracketId, bool rated)
+{
+    Battleground* bgTemplate = sBattlegroundMgr->GetBattlegroundTemplate(BATTLEGROUND_AA);
+    if (!bgTemplate)
+    {
+        return false;
+    }
+
+    PvPDifficultyEntry const* bracketEntry = GetBattlegroundBracketById(bgTemplate->GetMapId(), bracketId);
+    if (!bracketEntry)
+    {
+        return false;
+    }
+
+    Battleground* arena = sBattlegroundMgr->CreateNewBattleground(BATTLEGROUND_AA, bracketEntry, ARENA_TYPE_1v1, rated);
+    if (!arena)
+    {
+        TC_LOG_ERROR("bg.arena", "SoloArenaMgr::StartSoloMatch couldn't create arena instance for 1v1 match!");
+        return false;
+    }
+
+    BattlegroundQueue& bgQueue = sBattlegroundMgr->GetBattlegroundQueue(BATTLEGROUND_QUEUE_1v1);
+    MoveSoloGroupToTeam(bgQueue, first, bracketId, ALLIANCE);
+    MoveSoloGroupToTeam(bgQueue, second, bracketId, HORDE);
+
+    if (rated)
+    {
+        first->OpponentsTeamRating = second->ArenaTeamRating;
+        first->OpponentsMatchmakerRating = second->ArenaMatchmakerRating;
+        second->OpponentsTeamRating = first->ArenaTeamRating;
+        second->OpponentsMatchmakerRating = first->ArenaMatchmakerRating;
+
+        arena->SetArenaMatchmakerRating(ALLIANCE, first->ArenaMatchmakerRating);
+        arena->SetArenaMatchmakerRating(HORDE, second->ArenaMatchmakerRating);
+    }
+
+    bgQueue.InviteGroupToBG(first, arena, ALLIANCE);
+    bgQueue.InviteGroupToBG(second, arena, HORDE);
+
+    RegisterLiveMatch(arena, first, second, rated);
+
+    uint32 now = GameTime::GetGameTimeMS();
+    for (GroupQueueInfo* ginfo : { first, second })
+    {
+        Queues[bracketId].RecordWait(rated, GetMSTimeDiff(ginfo->JoinTime, now));
+        for (auto const& [guid, playerInfo] : ginfo->Players)
+        {
+            Queues[bracketId].Remove(guid.GetCounter());
+            InvitedPlayers.push_back(guid);
+            sSimpleGossipState->Bump(guid, SIMPLEGOSSIP_STATE_QUEUE);
+        }
+    }
+
+    arena->StartBattleground();
+
+    return true;
+}
+
+void ocRegisterForRated_Replace2v2(Player* player, bool success, SimpleGossipOptionIconTextPopup* option) { if (success) sSoloArenaMgr->RegisterForRated(player, FIRST_SLOT, true); }
+void ocRegisterForRated_Replace3v3(Player* player, bool success, SimpleGossipOptionIconTextPopup* option) { if (success) sSoloArenaMgr->RegisterForRated(player, SECOND_SLOT, true); }
+void ocRegisterForRated_Replace5v5(Player* player, bool success, SimpleGossipOptionIconTextPopup* option) { if (success) sSoloArenaMgr->RegisterForRated(player, THIRD_SLOT, true); }
+bool SoloArenaMgr::RegisterForRated(Player* player, ArenaTeamSlot replace, bool chatWarnings)
+{
+    ArenaTeam* currentSoloTeam = GetSoloArenaTeam(player);
+
+    if (currentSoloTeam != nullptr)
+    {
+        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("You are already registered for a Solo Arena Team.");
+        return false;
+    }
+
+    ArenaTeam* slot = sArenaTeamMgr->GetArenaTeamById(player->GetArenaTeamId(replace));
+    if (slot != nullptr)
+    {
+        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("You cannot register for Solo Arena Rated in that slot because you are already registered for an Arena Team in it.");
+        return false;
+    }
+
+    ArenaTeam* arenaTeam = new ArenaTeam();
+    auto arenaTeamName = GetSoloArenaTeamNameForPlayer(player->GetName());
+
+    ArenaTeamType type = FIVE_VS_FIVE;
+    switch (replace)
+    {
+    case FIRST_SLOT: type = TWO_VS_TWO; break;
+    case SECOND_SLOT: type = THREE_VS_THREE; break;
+    case THIRD_SLOT: type = FIVE_VS_FIVE; break;
+    }
+
+    if (!arenaTeam->Create(player->GetGUID(), type, arenaTeamName, BANNER_1, BANNER_2, BANNER_3, BANNER_4, BANNER_5))
+    {
+        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("Failed to create the Solo Arena Rated Team for some reason.");
+        delete arenaTeam;
+        return false;
+    }
+
+    // Register arena team
+    sArenaTeamMgr->AddArenaTeam(arenaTeam);
+
+    arenaTeam->AddMember(player->GetGUID());
+    arenaTeam->SaveToDB();
+    if (LadderLoaded)
+    {
+        Ladder.Add(arenaTeam);
+    }
+
+    sSimpleGossipState->Bump(player->GetGUID(), SIMPLEGOSSIP_STATE_ARENA_TEAM);
+
+    if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("You are now registered for Solo Arena Rated.");
+
+    return true;
+}
+
+void ocUnregisterFromRated(Player* player, bool success, SimpleGossipOptionIconTextPopup* option) { if (success) sSoloArenaMgr->UnregisterFromRated(player, true); }
+bool SoloArenaMgr::UnregisterFromRated(Player* player, bool chatWarnings)
+{
+    ArenaTeam* arenaTeam = GetSoloArenaTeam(player);
+
+    if (!arenaTeam)
+    {
+        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("You are not registered for Solo Arena Rated, so you cannot unregister.");
+        return false;
+    }
+
+    Ladder.Remove(arenaTeam->GetId());
+    arenaTeam->Disband();
+    sSimpleGossipState->Bump(player->GetGUID(), SIMPLEGOSSIP_STATE_ARENA_TEAM);
+
+    if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("Unregistered from Solo Arena Rated.");
+
+    return true;
+}
+
+bool ocdRegisterdAndNotInQueueP(Player* player, SimpleGossipPart* part)
+{
+    return ocdIsPlayerRegisteredP(player, part) && ocdIsNotInQueueForSoloArenaP(player, part);
+}
+bool ocdRegisterdAndNotInQueueO(Player* player, SimpleGossipOption* option)
+{
+    return ocdIsPlayerRegisteredO(player, option) && ocdIsNotInQueueForSoloArenaO(player, option);
+}
+void ocSwapRatedReplacement_Replace2v2(Player* player, SimpleGossipOptionIconText* option) { sSoloArenaMgr->SwapRatedReplacement(player, FIRST_SLOT, true); }
+void ocSwapRatedReplacement_Replace3v3(Player* player, SimpleGossipOptionIconText* option) { sSoloArenaMgr->SwapRatedReplacement(player, SECOND_SLOT, true); }
+void ocSwapRatedReplacement_Replace5v5(Player* player, SimpleGossipOptionIconText* option) { sSoloArenaMgr->SwapRatedReplacement(player, THIRD_SLOT, true); }
+bool SoloArenaMgr::SwapRatedReplacement(Player* player, ArenaTeamSlot replace, bool chatWarnings)
+{
+    ArenaTeam* arenaTeam;
+    arenaTeam = GetSoloArenaTeam(player);
+
+    if (!arenaTeam)
+    {
+        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("You are not registered for Solo Arena Rated, so you cannot swap your Arena Team's position.");
+        return false;
+    }
+
+    ArenaTeam* slot;
+    slot = sArenaTeamMgr->GetArenaTeamById(player->GetArenaTeamId(replace));
+    if (slot != nullptr)
+    {
+        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("You cannot swap your Solo Arena Rated Team to a position that's already occupied with an Arena Team.");
+        return false;
+    }
+
+    ArenaTeamType type = FIVE_VS_FIVE;
+    switch (replace)
+    {
+    case FIRST_SLOT: type = TWO_VS_TWO; break;
+    case SECOND_SLOT: type = THREE_VS_THREE; break;
+    case THIRD_SLOT: type = FIVE_VS_FIVE; break;
+    }
+
+    std::string playerName = player->GetName();
+    std::string teamName = arenaTeam->GetName();
+    ObjectGuid playerGuid = player->GetGUID();
+    ArenaTeamMember* playerMemberPtr;
+    playerMemberPtr = arenaTeam->GetMember(playerGuid);
+
+    if (!playerMemberPtr)
+    {
+        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("Something went wrong trying to find you in your own team! Tell the devs.");
+        return false;
+    }
+
+    ArenaTeamMember playerMember = *playerMemberPtr;
+    ArenaTeamStats arenaTeamStats = arenaTeam->GetStats();
+
+    UnregisterFromRated(player, false);
+
+    ArenaTeam* arenaTeam2;
+    arenaTeam2 = new ArenaTeam();
+
+    uint8 c = 0;
+    do {
+        if (!arenaTeam2->Create(playerGuid, type, teamName, 4283124816, 45, 4294242303, 5, 4294705149))
+        {
+            c++;
+        }
+        else {
+            break;
+        }
+    } while (c < 10);
+
+    if (!arenaTeam2)
+    {
+        if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("Failed to swap your Solo Arena Rated Team, also it was deleted, get fucked.");
+        delete arenaTeam2;
+        return false;
+    }
+
+    // Register arena team
+    sArenaTeamMgr->AddArenaTeam(arenaTeam2);
+
+    arenaTeam2->AddMember(playerGuid);
+    arenaTeam2->SetStats(arenaTeamStats);
+    ArenaTeamMember* playerMember2;
+    playerMember2 = arenaTeam2->GetMember(playerName);
+    playerMember2->PersonalRating = playerMember.PersonalRating;
+    playerMember2->SeasonGames = playerMember.SeasonGames;
+    playerMember2->SeasonWins = playerMember.SeasonWins;
+    playerMember2->WeekGames = playerMember.WeekGames;
+    playerMember2->WeekWins = playerMember.WeekWins;
+
+    arenaTeam->SaveToDB();
+    sSimpleGossipState->Bump(playerGuid, SIMPLEGOSSIP_STATE_ARENA_TEAM);
+
+    if (chatWarnings) ChatHandler(player->GetSession()).SendSysMessage("Your Solo Arena Rated Team has had its position swapped.");
+
+    return true;
+}
+
+std::string getCaptainName(ArenaTeam* at)
+{
+    if (!at)
+    {
+        return "";
+    }
+    ArenaTeamMember* captain = at->GetMember(at->GetCaptain());
+    return captain ? captain->Name : "";
+}
+// We check that the team is a 1v1 based on the special name it uses.
+bool SoloArenaMgr::IsSoloArenaTeam(ArenaTeam* team)
+{
+    return team->GetName() == GetSoloArenaTeamNameForPlayer(getCaptainName(team));
+}
+bool sortRatedArenaTeams(ArenaTeam* a, ArenaTeam* b)
+{
+    return a->GetRating() > b->GetRating();
+}
+bool sortRatedArenaTeamsReverse(ArenaTeam* a, ArenaTeam* b)
+{
+    return a->GetRating() < b->GetRating();
+}
+void ocDisplayRatedStatistics(Player* player, SimpleGossipOptionIconText* option) { sSoloArenaMgr->DisplayRatedStatistics(player); }
+bool SoloArenaMgr::DisplayRatedStatistics(Player* player)
+{
+    ArenaTeam* at;
+    at = GetSoloArenaTeam(player);
+
+    if (!at)
     {
         ChatHandler(player->GetSession()).SendSysMessage(COLOR(COLOR_SOLOARENATEAMNAME, "You are currently not in a Solo Arena Team, and thus you cannot see your stats."));
         return true;
     }
 
-    auto stats = at->GetStats();
-    auto color = COLOR_WHITE;
-    switch (stats.Rank)
+    auto stats = at->GetStats();
+    auto color = COLOR_WHITE;
+    switch (stats.Rank)
+    {
+    case 0:
+    case 1:
+        color = COLOR_GOLD; break;
+    case 2:
+        color = COLOR_SILVER; break;
+    case 3:
+        color = COLOR_COPPER; break;
+    case 4: case 5:
+        color = COLOR_WOOD; break;
+    }
+
+    ChatHandler(player->GetSession()).SendSysMessage(COLOR(COLOR_SOLOARENATEAMNAME, "Your Solo Arena Stats:"));
+    ChatHandler(player->GetSession()).SendSysMessage(
+        COLOR(color, getCaptainName(at))
+        + " Rating: " + COLOR(color, std::to_string(stats.Rating))
+        + " Wins: " + COLOR(color, std::to_string(stats.SeasonWins))
+        + " Loses: " + COLOR(color, std::to_string(stats.SeasonGames - stats.SeasonWins))
+        + " Weekly Wins: " + COLOR(color, std::to_string(stats.WeekWins))
+        + " Weekly Loses: " + COLOR(color, std::to_string(stats.WeekGames - stats.WeekWins)));
+
+    return true;
+}
+
+void ocDisplayServerStatistics(Player* player, SimpleGossipOptionIconText* option) { sSoloArenaMgr->DisplayServerStatistics(player); }
+bool SoloArenaMgr::DisplayServerStatistics(Player* player)
+{
+    ArenaTeamMgr::ArenaTeamContainer atc = sArenaTeamMgr->GetArenaTeams();
+
+    uint32 size = atc.size();
+
+    if (size == 0)
+    {
+        ChatHandler(player->GetSession()).SendSysMessage(COLOR(COLOR_SOLOARENATEAMNAME, "There are currently no Solo Arena Teams."));
+        return true;
+    }
+
+    std::vector<ArenaTeam*> ats;
+
+    for (auto kv : atc) {
+        if (IsSoloArenaTeam(kv.second))
+        {
+            ats.push_back(kv.second);
+        }
+    }
+
+    sort(ats.begin(), ats.end(), sortRatedArenaTeams);
+
+    size = ats.size();
+
+    uint32 range = 10;
+    if (size < range)
+    {
+        range = size;
+    }
+    if (range <= 0)
+    {
+        ChatHandler(player->GetSession()).SendSysMessage(COLOR(COLOR_SOLOARENATEAMNAME, "There are currently no Solo Arena Teams."));
+        return true;
+    }
+
+    std::vector<ArenaTeam*> firstTen(ats.cbegin(), ats.cbegin() + range + 1);
+
+    ChatHandler(player->GetSession()).SendSysMessage(COLOR(COLOR_SOLOARENATEAMNAME, "Solo Arena Rankings for the Server:"));
+    for (uint32 i = 0; i < range; i++)
+    {
+        ArenaTeam* at = firstTen[i];
+        std::string color = COLOR_WHITE;
+        switch (i)
+        {
+        case 0: color = COLOR_GOLD; break;
+        case 1: color = COLOR_SILVER; break;
+        case 2: color = COLOR_COPPER; break;
+        case 3:
+        case 4:
+        case 5:
+            color = COLOR_WOOD; break;
+        }
+
+        std::string captainName = getCaptainName(at);
+        if (captainName.size() < 12)
+        {
+            captainName.append(12 - captainName.size(), ' ');
+        }
+
+        auto stats = at->GetStats();
+
+        ChatHandler(player->GetSession()).SendSysMessage(
+            COLOR(color, getCaptainName(at))
+            + " Rating: " + COLOR(color, std::to_string(stats.Rating))
+            + " Wins: " + COLOR(color, std::to_string(stats.SeasonWins))
+            + " Loses: " + COLOR(color, std::to_string(stats.SeasonGames - stats.SeasonWins))
+            + " Weekly Wins: " + COLOR(color, std::to_string(stats.WeekWins))
+            + " Weekly Loses: " + COLOR(color, std::to_string(stats.WeekGames - stats.WeekWins)));
+    }
+
+    return true;
+}
+
+void ocDisplayRecentMatches(Player* player, SimpleGossipOptionIconText* option) { sSoloArenaMgr->DisplayRecentMatches(player); }
+bool SoloArenaMgr::DisplayRecentMatches(Player* player)
+{
+    auto itr = MatchHistories.find(player->GetGUID().GetCounter());
+    if (itr == MatchHistories.end() || itr->second.GetCount() == 0)
+    {
+        ChatHandler(player->GetSession()).SendSysMessage(COLOR(COLOR_SOLOARENATEAMNAME, "You haven't played any Solo Arena matches yet."));
+        return true;
+    }
+
+    ChatHandler handler(player->GetSession());
+    handler.SendSysMessage(COLOR(COLOR_SOLOARENATEAMNAME, "Your Recent Solo Arena Matches:"));
+
+    itr->second.ForEachNewestFirst([&](SoloArenaMatchResult const& result)
+    {
+        std::string opponentName = "Unknown";
+        sCharacterCache->GetCharacterNameByGuid(ObjectGuid::Create<HighGuid::Player>(result.Opponent), opponentName);
+
+        std::string color = result.Won ? COLOR_GREEN : COLOR_RED;
+        std::string line = COLOR(color, result.Won ? "Won" : "Lost") + " vs " + COLOR(COLOR_WHITE, opponentName);
+        if (result.Rated)
+        {
+            line += " Rating: " + COLOR(color, (result.RatingChange >= 0 ? "+" : "") + std::to_string(result.RatingChange));
+        }
+        else
+        {
+            line += " " + COLOR(COLOR_WOOD, "Skrimish");
+        }
+        line += " Duration: " + std::to_string(result.Duration / MINUTE) + "m " + std::to_string(result.Duration % MINUTE) + "s";
+        line += " " + std::to_string((uint32(GameTime::GetGameTime()) - result.EndTime) / MINUTE) + " minutes ago";
+
+        handler.SendSysMessage(line);
+    });
+
+    return true;
+}
+
+// Called by the core whenever a player enters a 1v1 arena, remembers both sides so the result can be attributed even if one leaves.
+void SoloArenaMgr::OnSoloPlayerAdded(Battleground* bg, Player* player)
+{
+    TeamId teamId = Battleground::GetTeamIndexByTeamId(player->GetBGTeam());
+    ActiveSoloMatch& match = ActiveSoloMatches[bg->GetInstanceID()];
+    match.Players[teamId] = player->GetGUID();
+    match.Tabs[teamId] = GetMatchupTab(player);
+}
+
+// Dense index of the talent tab with the most points in the active spec
+uint8 SoloArenaMgr::GetMatchupTab(Player* player)
+{
+    TalentTabEntry const* tab = sTalentTabStore.LookupEntry(player->GetPrimaryTalentTree(player->GetActiveSpec()));
+    if (!tab)
+    {
+        return SOLO_ARENA_MATCHUP_UNKNOWN_TAB;
+    }
+    return SoloArenaMatchups::GetTab(player->GetClass(), tab->OrderIndex);
+}
+
+// Called by the core when a 1v1 arena ends, after the rating changes were applied.
+void SoloArenaMgr::OnSoloMatchEnd(Battleground* bg, uint32 winner, int32 allianceRatingChange, int32 hordeRatingChange)
+{
+    auto itr = ActiveSoloMatches.find(bg->GetInstanceID());
+    if (itr == ActiveSoloMatches.end())
+    {
+        return;
+    }
+
+    ActiveSoloMatch match = itr->second;
+    UnregisterLiveMatch(bg->GetInstanceID());
+
+    if (bg->isRated() && (winner == ALLIANCE || winner == HORDE))
+    {
+        TeamId winnerId = winner == ALLIANCE ? TEAM_ALLIANCE : TEAM_HORDE;
+        TeamId loserId = winner == ALLIANCE ? TEAM_HORDE : TEAM_ALLIANCE;
+        Matchups.Record(SoloArenaMatchups::GetBand(match.CombinedRating / PVP_TEAMS_COUNT), match.Tabs[winnerId], match.Tabs[loserId]);
+    }
+
+    int32 ratingChanges[PVP_TEAMS_COUNT] = { allianceRatingChange, hordeRatingChange };
+    for (uint8 teamId = TEAM_ALLIANCE; teamId < PVP_TEAMS_COUNT; ++teamId)
+    {
+        ObjectGuid guid = match.Players[teamId];
+        if (guid.IsEmpty())
+        {
+            continue;
+        }
+
+        SoloArenaMatchResult result;
+        result.Opponent = match.Players[teamId == TEAM_ALLIANCE ? TEAM_HORDE : TEAM_ALLIANCE].GetCounter();
+        result.RatingChange = bg->isRated() ? int16(ratingChanges[teamId]) : 0;
+        result.Won = winner == (teamId == TEAM_ALLIANCE ? ALLIANCE : HORDE);
+        result.Rated = bg->isRated();
+        result.Duration = bg->GetStartTime() / IN_MILLISECONDS;
+        result.EndTime = uint32(GameTime::GetGameTime());
+
+        RecordMatchResult(guid, result);
+    }
+}
+
+/// <summary>
+/// Rated 1v1 finish called by Arena::EndBattleground instead of its generic team code.
+/// Both teams have their only member as captain, so the rules of ArenaTeam::WonAgainst, LostAgainst, MemberWon and MemberLost
+/// are applied to one member per side, both team ranks come from one pass over the arena teams and everything is saved in one transaction.
+/// </summary>
+/// <param name="winner">ALLIANCE, HORDE or 0 for a draw, which costs both teams ARENA_TIMELIMIT_POINTS_LOSS and leaves the members alone.</param>
+/// <param name="finish">Receives the scoreboard values, indexed by PvPTeamId.</param>
+/// <returns value="false">The teams aren't two different single member teams, the generic code has to handle the match.</returns>
+bool SoloArenaMgr::FinishRatedSoloMatch(Battleground* bg, uint32 winner, SoloArenaFinish& finish)
+{
+    uint32 const teams[PVP_TEAMS_COUNT] = { ALLIANCE, HORDE };
+    ArenaTeam* arenaTeams[PVP_TEAMS_COUNT];
+    ArenaTeamMember* members[PVP_TEAMS_COUNT];
+    uint32 matchmakerRatings[PVP_TEAMS_COUNT];
+    for (uint8 side = TEAM_ALLIANCE; side < PVP_TEAMS_COUNT; ++side)
+    {
+        arenaTeams[side] = sArenaTeamMgr->GetArenaTeamById(bg->GetArenaTeamIdForTeam(teams[side]));
+        if (!arenaTeams[side] || arenaTeams[side]->GetMembersSize() != 1)
+        {
+            return false;
+        }
+        members[side] = arenaTeams[side]->GetMember(arenaTeams[side]->GetCaptain());
+        if (!members[side])
+        {
+            return false;
+        }
+        matchmakerRatings[side] = bg->GetArenaMatchmakerRating(teams[side]);
+    }
+    if (arenaTeams[TEAM_ALLIANCE] == arenaTeams[TEAM_HORDE])
+    {
+        return false;
+    }
+
+    ArenaTeamStats stats[PVP_TEAMS_COUNT];
+    int32 ratingChanges[PVP_TEAMS_COUNT];
+    int32 matchmakerChanges[PVP_TEAMS_COUNT];
+    for (uint8 side = TEAM_ALLIANCE; side < PVP_TEAMS_COUNT; ++side)
+    {
+        uint8 other = side == TEAM_ALLIANCE ? TEAM_HORDE : TEAM_ALLIANCE;
+        bool won = winner == teams[side];
+        stats[side] = arenaTeams[side]->GetStats();
+
+        if (winner)
+        {
+            ratingChanges[side] = arenaTeams[side]->GetRatingMod(stats[side].Rating, matchmakerRatings[other], won);
+            matchmakerChanges[side] = arenaTeams[side]->GetMatchmakerRatingMod(matchmakerRatings[side], matchmakerRatings[other], won);
+        }
+        else
+        {
+            ratingChanges[side] = ARENA_TIMELIMIT_POINTS_LOSS;
+            matchmakerChanges[side] = 0;
+        }
+
+        stats[side].Rating = uint32(std::max(0, int32(stats[side].Rating) + ratingChanges[side]));
+        stats[side].WeekGames += 1;
+        stats[side].SeasonGames += 1;
+        if (won)
+        {
+            stats[side].WeekWins += 1;
+            stats[side].SeasonWins += 1;
+        }
+        stats[side].Rank = 1;
+    }
+
+    // Same ranking as ArenaTeam::FinishGame, for both teams at once and with their new ratings
+    if (arenaTeams[TEAM_ALLIANCE]->GetType() == arenaTeams[TEAM_HORDE]->GetType())
+    {
+        if (stats[TEAM_HORDE].Rating > stats[TEAM_ALLIANCE].Rating)
+        {
+            ++stats[TEAM_ALLIANCE].Rank;
+        }
+        else if (stats[TEAM_ALLIANCE].Rating > stats[TEAM_HORDE].Rating)
+        {
+            ++stats[TEAM_HORDE].Rank;
+        }
+    }
+    for (auto const& [teamId, team] : sArenaTeamMgr->GetArenaTeams())
+    {
+        if (team == arenaTeams[TEAM_ALLIANCE] || team == arenaTeams[TEAM_HORDE])
+        {
+            continue;
+        }
+        for (uint8 side = TEAM_ALLIANCE; side < PVP_TEAMS_COUNT; ++side)
+        {
+            if (team->GetType() == arenaTeams[side]->GetType() && team->GetStats().Rating > stats[side].Rating)
+            {
+                ++stats[side].Rank;
+            }
+        }
+    }
+
+    BattlegroundPlayerMap const& players = bg->GetPlayers();
+    CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
+    for (uint8 side = TEAM_ALLIANCE; side < PVP_TEAMS_COUNT; ++side)
+    {
+        ArenaTeam* arenaTeam = arenaTeams[side];
+        ArenaTeamMember* member = members[side];
+        uint8 other = side == TEAM_ALLIANCE ? TEAM_HORDE : TEAM_ALLIANCE;
+        bool won = winner == teams[side];
+        arenaTeam->SetStats(stats[side]);
+        bg->SetArenaMatchmakerRating(teams[side], matchmakerRatings[side] + matchmakerChanges[side]);
+
+        // A member who left already took the loss in Battleground::RemovePlayerAtLeave, like the generic code only the team is rated then.
+        // Disconnected members are rated without a player, as ArenaTeam::OfflineMemberWon and OfflineMemberLost do.
+        auto itr = players.find(member->Guid);
+        bool present = itr != players.end();
+        Player* player = nullptr;
+        if (present && !itr->second.OfflineRemoveTime)
+        {
+            player = ObjectAccessor::FindPlayer(member->Guid);
+        }
+
+        if (player && won)
+        {
+            player->UpdateAchievementCriteria(ACHIEVEMENT_CRITERIA_TYPE_WIN_RATED_ARENA, member->PersonalRating ? member->PersonalRating : 1);
+            player->UpdateAchievementCriteria(ACHIEVEMENT_CRITERIA_TYPE_WIN_ARENA, bg->GetMapId());
+        }
+        if (player && stats[side].Rating)
+        {
+            player->UpdateAchievementCriteria(ACHIEVEMENT_CRITERIA_TYPE_HIGHEST_TEAM_RATING, stats[side].Rating, arenaTeam->GetType());
+        }
+
+        // Personal rating moves against the opponent's matchmaker rating on its own, a draw only touches the teams
+        if (present && winner)
+        {
+            member->ModifyPersonalRating(player, arenaTeam->GetRatingMod(member->PersonalRating, matchmakerRatings[other], won), arenaTeam->GetType());
+            member->ModifyMatchmakerRating(matchmakerChanges[side], arenaTeam->GetSlot());
+            member->WeekGames += 1;
+            member->SeasonGames += 1;
+            if (won)
+            {
+                member->WeekWins += 1;
+                member->SeasonWins += 1;
+            }
+        }
+
+        if (player)
+        {
+            player->SetArenaTeamInfoField(arenaTeam->GetSlot(), ARENA_TEAM_GAMES_WEEK, member->WeekGames);
+            player->SetArenaTeamInfoField(arenaTeam->GetSlot(), ARENA_TEAM_GAMES_SEASON, member->SeasonGames);
+            if (!won)
+            {
+                player->ResetAchievementCriteria(ACHIEVEMENT_CRITERIA_CONDITION_NO_LOSE, 0);
+            }
+        }
+
+        // The statements of ArenaTeam::SaveToDB, for both teams in one transaction
+        CharacterDatabasePreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_UPD_ARENA_TEAM_STATS);
+        stmt->setUInt16(0, stats[side].Rating);
+        stmt->setUInt16(1, stats[side].WeekGames);
+        stmt->setUInt16(2, stats[side].WeekWins);
+        stmt->setUInt16(3, stats[side].SeasonGames);
+        stmt->setUInt16(4, stats[side].SeasonWins);
+        stmt->setUInt32(5, stats[side].Rank);
+        stmt->setUInt32(6, arenaTeam->GetId());
+        trans->Append(stmt);
+
+        stmt = CharacterDatabase.GetPreparedStatement(CHAR_UPD_ARENA_TEAM_MEMBER);
+        stmt->setUInt16(0, member->PersonalRating);
+        stmt->setUInt16(1, member->WeekGames);
+        stmt->setUInt16(2, member->WeekWins);
+        stmt->setUInt16(3, member->SeasonGames);
+        stmt->setUInt16(4, member->SeasonWins);
+        stmt->setUInt32(5, arenaTeam->GetId());
+        stmt->setUInt32(6, member->Guid.GetCounter());
+        trans->Append(stmt);
+
+        stmt = CharacterDatabase.GetPreparedStatement(CHAR_REP_CHARACTER_ARENA_STATS);
+        stmt->setUInt32(0, member->Guid.GetCounter());
+        stmt->setUInt8(1, arenaTeam->GetSlot());
+        stmt->setUInt16(2, member->MatchMakerRating);
+        trans->Append(stmt);
+
+        if (LadderLoaded && Ladder.Contains(arenaTeam->GetId()))
+        {
+            Ladder.Add(arenaTeam);
+        }
+
+        uint8 pvpTeam = teams[side] == ALLIANCE ? PVP_TEAM_ALLIANCE : PVP_TEAM_HORDE;
+        finish.RatingChange[pvpTeam] = ratingChanges[side];
+        finish.MatchmakerRating[pvpTeam] = matchmakerRatings[side];
+        finish.TeamName[pvpTeam] = arenaTeam->GetName();
+    }
+    CharacterDatabase.CommitTransaction(trans);
+
+    TC_LOG_DEBUG("bg.arena", "SoloArenaMgr: 1v1 arena %u finished, winner %u, team %u %+d rating %+d mmr, team %u %+d rating %+d mmr",
+        bg->GetInstanceID(), winner, arenaTeams[TEAM_ALLIANCE]->GetId(), ratingChanges[TEAM_ALLIANCE], matchmakerChanges[TEAM_ALLIANCE],
+        arenaTeams[TEAM_HORDE]->GetId(), ratingChanges[TEAM_HORDE], matchmakerChanges[TEAM_HORDE]);
+
+    arenaTeams[TEAM_ALLIANCE]->NotifyStatsChanged();
+    arenaTeams[TEAM_HORDE]->NotifyStatsChanged();
+    return true;
+}
+
+// Called by the core when a 1v1 arena is deleted, which also happens for matches that never ended because nobody entered.
+void SoloArenaMgr::OnSoloArenaDeleted(Battleground* bg)
+{
+    UnregisterLiveMatch(bg->GetInstanceID());
+}
+
+// Each side of a 1v1 is a single player, so the match knows both of them before they enter
+void SoloArenaMgr::RegisterLiveMatch(Battleground* arena, GroupQueueInfo* first, GroupQueueInfo* second, bool rated)
+{
+    ActiveSoloMatch& match = ActiveSoloMatches[arena->GetInstanceID()];
+    if (match.Listed)
+    {
+        LiveMatchesByRating.erase({ match.CombinedRating, match.InstanceId });
+        LiveMatchCursorPlace = UINT32_MAX;
+    }
+
+    GroupQueueInfo* sides[PVP_TEAMS_COUNT] = { first, second };
+    for (uint8 teamId = TEAM_ALLIANCE; teamId < PVP_TEAMS_COUNT; ++teamId)
+    {
+        if (!sides[teamId]->Players.empty())
+        {
+            match.Players[teamId] = sides[teamId]->Players.begin()->first;
+        }
+        match.Rating[teamId] = rated ? sides[teamId]->ArenaMatchmakerRating : 0;
+    }
+
+    match.InstanceId = arena->GetInstanceID();
+    match.CombinedRating = match.Rating[TEAM_ALLIANCE] + match.Rating[TEAM_HORDE];
+    match.StartTime = uint32(GameTime::GetGameTime());
+    match.Rated = rated;
+    match.Listed = true;
+
+    LiveMatchesByRating.emplace(match.CombinedRating, match.InstanceId);
+    LiveMatchCursorPlace = UINT32_MAX;
+}
+
+void SoloArenaMgr::UnregisterLiveMatch(uint32 instanceId)
+{
+    auto itr = ActiveSoloMatches.find(instanceId);
+    if (itr == ActiveSoloMatches.end())
+    {
+        return;
+    }
+
+    if (itr->second.Listed)
+    {
+        LiveMatchesByRating.erase({ itr->second.CombinedRating, instanceId });
+        LiveMatchCursorPlace = UINT32_MAX;
+    }
+    ActiveSoloMatches.erase(itr);
+}
+
+ActiveSoloMatch const* SoloArenaMgr::GetLiveMatch(uint32 instanceId) const
+{
+    auto itr = ActiveSoloMatches.find(instanceId);
+    if (itr == ActiveSoloMatches.end() || !itr->second.Listed)
+    {
+        return nullptr;
+    }
+    return &itr->second;
+}
+
+// Place 0 is the highest rated match
+// Pages ask for consecutive places, so the walk goes on from the last place asked for and a page costs one walk
+ActiveSoloMatch const* SoloArenaMgr::GetLiveMatchByPlace(uint32 place) const
+{
+    if (place >= LiveMatchesByRating.size())
+    {
+        return nullptr;
+    }
+
+    if (LiveMatchCursorPlace > place)
+    {
+        LiveMatchCursor = LiveMatchesByRating.begin();
+        LiveMatchCursorPlace = 0;
+    }
+    LiveMatchCursor = std::next(LiveMatchCursor, place - LiveMatchCursorPlace);
+    LiveMatchCursorPlace = place;
+    return &ActiveSoloMatches.at(LiveMatchCursor->second);
+}
+
+std::string SoloArenaMgr::DescribeLiveMatch(ActiveSoloMatch const& match) const
+{
+    std::string names[PVP_TEAMS_COUNT] = { "Unknown", "Unknown" };
+    for (uint8 teamId = TEAM_ALLIANCE; teamId < PVP_TEAMS_COUNT; ++teamId)
+    {
+        sCharacterCache->GetCharacterNameByGuid(match.Players[teamId], names[teamId]);
+    }
+
+    std::string line = names[TEAM_ALLIANCE];
+    if (match.Rated)
+    {
+        line += " (" + std::to_string(match.Rating[TEAM_ALLIANCE]) + ")";
+    }
+    line += " vs " + names[TEAM_HORDE];
+    if (match.Rated)
+    {
+        line += " (" + std::to_string(match.Rating[TEAM_HORDE]) + ")";
+    }
+    else
+    {
+        line += " Skrimish";
+    }
+    line += ", " + std::to_string((uint32(GameTime::GetGameTime()) - match.StartTime) / MINUTE) + "m";
+    return line;
+}
+
+bool gLiveMatches(Player* player, uint32 index, SimpleGossipGeneratedItem& item)
+{
+    if (index >= sSoloArenaMgr->LiveMatchesShown)
+    {
+        return false;
+    }
+
+    ActiveSoloMatch const* match = sSoloArenaMgr->GetLiveMatchByPlace(index);
+    if (!match)
+    {
+        return false;
+    }
+
+    item.Icon = GOSSIP_ICON_BATTLE;
+    item.Text = std::to_string(index + 1) + ". " + sSoloArenaMgr->DescribeLiveMatch(*match);
+    return true;
+}
+
+void gcLiveMatches(Player* player, uint32 index, SimpleGossipOptionGenerator* option) { sSoloArenaMgr->DisplayLiveMatch(player, index); }
+// The list may have moved on since it was shown, the place is looked up again
+bool SoloArenaMgr::DisplayLiveMatch(Player* player, uint32 place)
+{
+    ChatHandler handler(player->GetSession());
+    ActiveSoloMatch const* match = GetLiveMatchByPlace(place);
+    if (!match)
+    {
+        handler.SendSysMessage(COLOR(COLOR_SOLOARENATEAMNAME, "That Solo Arena match has already ended."));
+        return false;
+    }
+
+    handler.SendSysMessage(COLOR(COLOR_SOLOARENATEAMNAME, "Live Solo Arena match #" + std::to_string(place + 1) + ": ") + COLOR(COLOR_WHITE, DescribeLiveMatch(*match)));
+    if (player->IsGameMaster())
+    {
+        handler.PSendSysMessage("Use .soloarena spectate %u to watch it.", match->InstanceId);
+    }
+    return true;
+}
+
+// Like .appear into a battleground, the arena sends the spectator back to the entry point once it ends
+bool SoloArenaMgr::SpectateLiveMatch(Player* player, uint32 instanceId)
+{
+    if (!GetLiveMatch(instanceId))
+    {
+        return false;
+    }
+
+    Battleground* bg = sBattlegroundMgr->GetBattleground(instanceId, BATTLEGROUND_TYPE_NONE);
+    if (!bg)
+    {
+        return false;
+    }
+
+    if (player->GetBattlegroundId() && player->GetBattlegroundId() != instanceId)
+    {
+        player->LeaveBattleground(false);
+    }
+
+    player->SetBattlegroundId(bg->GetInstanceID(), bg->GetTypeID());
+    if (!player->GetMap()->IsBattlegroundOrArena())
+    {
+        player->SetBattlegroundEntryPoint();
+    }
+
+    Position const* pos = bg->GetTeamStartPosition(TEAM_ALLIANCE);
+    return player->TeleportTo(bg->GetMapId(), pos->GetPositionX(), pos->GetPositionY(), pos->GetPositionZ() + 5.0f, pos->GetOrientation(), TELE_TO_GM_MODE);
+}
+
+// Rated results always belong to a registered player, skrimish results only get a ring when the player is registered.
+void SoloArenaMgr::RecordMatchResult(ObjectGuid guid, SoloArenaMatchResult const& result)
+{
+    auto itr = MatchHistories.find(guid.GetCounter());
+    if (itr == MatchHistories.end())
+    {
+        if (!result.Rated)
+        {
+            Player* player = ObjectAccessor::FindConnectedPlayer(guid);
+            if (!player || !IsPlayerRegistered(player))
+            {
+                return;
+            }
+        }
+        itr = MatchHistories.emplace(guid.GetCounter(), SoloArenaMatchHistory()).first;
+    }
+
+    if (itr->second.GetUnflushed() == 0)
+    {
+        DirtyMatchHistories.push_back(guid.GetCounter());
+    }
+    itr->second.Add(result);
+}
+
+void SoloArenaMgr::LoadMatchHistories()
+{
+    uint32 oldMSTime = getMSTime();
+
+    MatchHistories.clear();
+    DirtyMatchHistories.clear();
+
+    //                                                      0     1        2            3       4       5          6
+    QueryResult result = CharacterDatabase.Query("SELECT guid, slot, opponent, ratingChange, won, rated, duration, endTime FROM character_solo_arena_history ORDER BY guid, endTime");
+    MatchHistoriesLoaded = true;
+    if (!result)
     {
-    case 0:
-    case 1:
-        color = COLOR_GOLD; break;
-    case 2:
-        color = COLOR_SILVER; break;
-    case 3:
-        color = COLOR_COPPER; break;
-    case 4: case 5:
-        color = COLOR_WOOD; break;
+        TC_LOG_INFO("server.loading", ">> Loaded 0 Solo Arena match results. DB table `character_solo_arena_history` is empty.");
+        return;
     }
 
-    ChatHandler(player->GetSession()).SendSysMessage(COLOR(COLOR_SOLOARENATEAMNAME, "Your Solo Arena Stats:"));
-    ChatHandler(player->GetSession()).SendSysMessage(
-        COLOR(color, getCaptainName(at))
-        + " Rating: " + COLOR(color, std::to_string(stats.Rating))
-        + " Wins: " + COLOR(color, std::to_string(stats.SeasonWins))
-        + " Loses: " + COLOR(color, std::to_string(stats.SeasonGames - stats.SeasonWins))
-        + " Weekly Wins: " + COLOR(color, std::to_string(stats.WeekWins))
-        + " Weekly Loses: " + COLOR(color, std::to_string(stats.WeekGames - stats.WeekWins)));
+    uint32 count = 0;
+    do
+    {
+        Field* fields = result->Fetch();
 
-    return true;
+        SoloArenaMatchResult matchResult;
+        matchResult.Opponent = fields[2].GetUInt32();
+        matchResult.RatingChange = fields[3].GetInt16();
+        matchResult.Won = fields[4].GetBool();
+        matchResult.Rated = fields[5].GetBool();
+        matchResult.Duration = fields[6].GetUInt32();
+        matchResult.EndTime = fields[7].GetUInt32();
+
+        MatchHistories[fields[0].GetUInt32()].Load(fields[1].GetUInt8(), matchResult);
+        ++count;
+    } while (result->NextRow());
+
+    TC_LOG_INFO("server.loading", ">> Loaded %u Solo Arena match results for %u players in %u ms", count, uint32(MatchHistories.size()), GetMSTimeDiffToNow(oldMSTime));
 }
 
-void ocDisplayServerStatistics(Player* player, SimpleGossipOptionIconText* option) { sSoloArenaMgr->DisplayServerStatistics(player); }
-bool SoloArenaMgr::DisplayServerStatistics(Player* player)
+// Writes every result added since the last flush in one transaction. Only shutdown waits for it.
+void SoloArenaMgr::FlushMatchHistories(bool direct)
+{
+    if (DirtyMatchHistories.empty())
+    {
+        return;
+    }
+
+    CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
+    for (uint32 guid : DirtyMatchHistories)
+    {
+        auto itr = MatchHistories.find(guid);
+        if (itr == MatchHistories.end())
+        {
+            continue;
+        }
+
+        SoloArenaMatchHistory& history = itr->second;
+        for (uint8 i = 0; i < history.GetUnflushed(); ++i)
+        {
+            SoloArenaMatchResult const& result = history.GetResult(i);
+            trans->PAppend("REPLACE INTO character_solo_arena_history (guid, slot, opponent, ratingChange, won, rated, duration, endTime) VALUES (%u, %u, %u, %d, %u, %u, %u, %u)",
+                guid, history.GetSlot(i), result.Opponent, result.RatingChange, result.Won ? 1 : 0, result.Rated ? 1 : 0, result.Duration, result.EndTime);
+        }
+        history.MarkFlushed();
+    }
+    DirtyMatchHistories.clear();
+
+    if (direct)
+    {
+        CharacterDatabase.DirectCommitTransaction(trans);
+    }
+    else
+    {
+        CharacterDatabase.CommitTransaction(trans);
+    }
+}
+
+void SoloArenaMgr::LoadMatchups()
+{
+    uint32 oldMSTime = getMSTime();
+
+    Matchups.Clear();
+
+    //                                                   0          1         2     3
+    QueryResult result = CharacterDatabase.Query("SELECT band, winnerTab, loserTab, wins FROM solo_arena_matchups");
+    MatchupsLoaded = true;
+    if (!result)
+    {
+        TC_LOG_INFO("server.loading", ">> Loaded 0 Solo Arena matchups. DB table `solo_arena_matchups` is empty.");
+        return;
+    }
+
+    uint32 count = 0;
+    do
+    {
+        Field* fields = result->Fetch();
+        Matchups.Load(fields[0].GetUInt8(), fields[1].GetUInt8(), fields[2].GetUInt8(), fields[3].GetUInt32());
+        ++count;
+    } while (result->NextRow());
+
+    TC_LOG_INFO("server.loading", ">> Loaded %u Solo Arena matchups in %u ms", count, GetMSTimeDiffToNow(oldMSTime));
+}
+
+// Writes the cells changed since the last flush with multi row statements, at most SOLO_ARENA_MATCHUP_TABS rows each.
+void SoloArenaMgr::FlushMatchups(bool direct)
 {
+    std::vector<uint16> const& dirty = Matchups.GetDirty();
+    if (dirty.empty())
+    {
+        return;
+    }
+
+    CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
+    for (size_t i = 0; i < dirty.size(); i += SOLO_ARENA_MATCHUP_TABS)
+    {
+        std::string query = "REPLACE INTO solo_arena_matchups (band, winnerTab, loserTab, wins) VALUES ";
+        size_t end = std::min<size_t>(i + SOLO_ARENA_MATCHUP_TABS, dirty.size());
+        for (size_t j = i; j < end; ++j)
+        {
+            uint32 cell = dirty[j];
+            if (j != i)
+            {
+                query += ",";
+            }
+            query += "(" + std::to_string(cell / SOLO_ARENA_MATCHUP_TABS / SOLO_ARENA_MATCHUP_TABS)
+                + "," + std::to_string(cell / SOLO_ARENA_MATCHUP_TABS % SOLO_ARENA_MATCHUP_TABS)
+                + "," + std::to_string(cell % SOLO_ARENA_MATCHUP_TABS)
+                + "," + std::to_string(Matchups.GetWinsOfCell(cell)) + ")";
+        }
+        trans->Append(query.c_str());
+    }
+    Matchups.MarkFlushed();
+
+    if (direct)
+    {
+        CharacterDatabase.DirectCommitTransaction(trans);
+    }
+    else
+    {
+        CharacterDatabase.CommitTransaction(trans);
+    }
+}
+
+// Rebuilds the struct of arrays ladder from the arena team store.
+void SoloArenaMgr::LoadLadder()
+{
+    Ladder.Clear();
+
     ArenaTeamMgr::ArenaTeamContainer atc = sArenaTeamMgr->GetArenaTeams();
+    Ladder.Reserve(atc.size());
+    for (auto kv : atc)
+    {
+        if (IsSoloArenaTeam(kv.second))
+        {
+            Ladder.Add(kv.second);
+        }
+    }
+}
 
-    uint32 size = atc.size();
+// Called once the arena teams are loaded. A snapshot that still matches them replaces finding the solo teams by name,
+// and when it is recent enough its queued players get their place back as they log in.
+void SoloArenaMgr::LoadSnapshot()
+{
+    uint32 oldMSTime = getMSTime();
 
-    if (size == 0)
+    SoloArenaSnapshot snapshot;
+    std::string error;
+    bool read = !SnapshotFile.empty() && snapshot.Read(SnapshotFile, error);
+    if (!read && !SnapshotFile.empty())
     {
-        ChatHandler(player->GetSession()).SendSysMessage(COLOR(COLOR_SOLOARENATEAMNAME, "There are currently no Solo Arena Teams."));
-        return true;
+        TC_LOG_INFO("server.loading", ">> Solo Arena snapshot not used: %s.", error.c_str());
     }
 
-    std::vector<ArenaTeam*> ats;
+    if (read && LoadLadderFromSnapshot(snapshot))
+    {
+        TC_LOG_INFO("server.loading", ">> Loaded %u Solo Arena teams from the snapshot in %u ms", uint32(Ladder.Size()), GetMSTimeDiffToNow(oldMSTime));
+    }
+    else
+    {
+        LoadLadder();
+        TC_LOG_INFO("server.loading", ">> Found %u Solo Arena teams in %u ms", uint32(Ladder.Size()), GetMSTimeDiffToNow(oldMSTime));
+    }
+    LadderLoaded = true;
 
-    for (auto kv : atc) {
-        ArenaTeam* kvat;
-        kvat = kv.second;
-        std::string teamName = kvat->GetName();
-        std::string captainName = getCaptainName(kvat);
+    PendingRequeues.clear();
+    uint32 now = uint32(GameTime::GetGameTime());
+    if (!read || now - snapshot.WrittenAt > SnapshotRequeueWindow)
+    {
+        return;
+    }
 
-        // We check that the team is a 1v1 based on the special name it uses.
-        if (teamName == GetSoloArenaTeamNameForPlayer(captainName))
+    for (uint32 i = 0; i < snapshot.AverageWaits.size() / 2 && i < MAX_BATTLEGROUND_BRACKETS; ++i)
+    {
+        Queues[i].SetAverageWait(false, snapshot.AverageWaits[i * 2]);
+        Queues[i].SetAverageWait(true, snapshot.AverageWaits[i * 2 + 1]);
+    }
+
+    // Characters deleted since the snapshot can't log in anymore
+    for (SoloArenaSnapshotQueueEntry const& entry : snapshot.Queue)
+    {
+        if (sCharacterCache->HasCharacterCacheEntry(ObjectGuid::Create<HighGuid::Player>(entry.Guid)))
         {
-            ats.push_back(kv.second);
+            PendingRequeues[entry.Guid] = entry;
         }
     }
+    RequeueDeadline = now + SnapshotRequeueWindow;
 
-    sort(ats.begin(), ats.end(), sortRatedArenaTeams);
+    if (PendingRequeues.size() != snapshot.Queue.size())
+    {
+        TC_LOG_INFO("server.loading", ">> %u of the %u queued players in the Solo Arena snapshot no longer exist", uint32(snapshot.Queue.size() - PendingRequeues.size()), uint32(snapshot.Queue.size()));
+    }
 
-    size = ats.size();
+    if (!PendingRequeues.empty())
+    {
+        TC_LOG_INFO("server.loading", ">> %u players get their Solo Arena queue place back if they log in within %u seconds", uint32(PendingRequeues.size()), SnapshotRequeueWindow);
+    }
+}
 
-    uint32 range = 10;
-    if (size < range)
+uint32 countArenaTeamMembers()
+{
+    uint32 count = 0;
+    for (auto const& [teamId, team] : sArenaTeamMgr->GetArenaTeams())
     {
-        range = size;
+        count += uint32(team->GetMembersSize());
     }
-    if (range <= 0)
+    return count;
+}
+
+// Every solo team of the snapshot has to exist with the same captain, and the arena_team and arena_team_member row counts
+// as well as the number of solo team rows in the database have to match the snapshot
+bool SoloArenaMgr::LoadLadderFromSnapshot(SoloArenaSnapshot const& snapshot)
+{
+    if (snapshot.ArenaTeamCount != sArenaTeamMgr->GetArenaTeams().size() || snapshot.ArenaTeamMemberCount != countArenaTeamMembers())
     {
-        ChatHandler(player->GetSession()).SendSysMessage(COLOR(COLOR_SOLOARENATEAMNAME, "There are currently no Solo Arena Teams."));
-        return true;
+        return false;
     }
 
-    std::vector<ArenaTeam*> firstTen(ats.cbegin(), ats.cbegin() + range + 1);
+    // Solo team names are the colored captain name, no other team name can start with a color code
+    QueryResult result = CharacterDatabase.PQuery("SELECT COUNT(*) FROM arena_team WHERE name LIKE '%s%%'", COLOR_SOLOARENATEAMNAME.c_str());
+    if (!result || (*result)[0].GetUInt64() != snapshot.Teams.size())
+    {
+        return false;
+    }
 
-    ChatHandler(player->GetSession()).SendSysMessage(COLOR(COLOR_SOLOARENATEAMNAME, "Solo Arena Rankings for the Server:"));
-    for (uint32 i = 0; i < range; i++)
+    Ladder.Clear();
+    Ladder.Reserve(snapshot.Teams.size());
+    for (SoloArenaSnapshotTeam const& row : snapshot.Teams)
     {
-        ArenaTeam* at = firstTen[i];
-        std::string color = COLOR_WHITE;
-        switch (i)
+        ArenaTeam* team = sArenaTeamMgr->GetArenaTeamById(row.TeamId);
+        if (!team || team->GetCaptain().GetCounter() != row.Captain)
         {
-        case 0: color = COLOR_GOLD; break;
-        case 1: color = COLOR_SILVER; break;
-        case 2: color = COLOR_COPPER; break;
-        case 3:
-        case 4:
-        case 5:
-            color = COLOR_WOOD; break;
+            Ladder.Clear();
+            return false;
         }
+        Ladder.Add(team);
+    }
+    return true;
+}
 
-        std::string captainName = getCaptainName(at);
-        if (captainName.size() < 12)
+// The queue is stored with the time already waited, game time restarts at 0 with the server
+void SoloArenaMgr::WriteSnapshot()
+{
+    if (!LadderLoaded)
+    {
+        return;
+    }
+
+    SoloArenaSnapshot snapshot;
+    snapshot.WrittenAt = uint32(GameTime::GetGameTime());
+    snapshot.ArenaTeamCount = uint32(sArenaTeamMgr->GetArenaTeams().size());
+    snapshot.ArenaTeamMemberCount = countArenaTeamMembers();
+
+    std::vector<uint32> rows(Ladder.Size());
+    for (uint32 i = 0; i < rows.size(); ++i)
+    {
+        rows[i] = i;
+    }
+    std::sort(rows.begin(), rows.end(), [this](uint32 a, uint32 b) { return Ladder.Ratings[a] > Ladder.Ratings[b]; });
+
+    snapshot.Teams.reserve(rows.size());
+    for (uint32 row : rows)
+    {
+        snapshot.Teams.push_back({ Ladder.TeamIds[row], Ladder.Captains[row], Ladder.Ratings[row] });
+    }
+
+    // Pairs still waiting for their start are queued players too
+    uint32 now = GameTime::GetGameTimeMS();
+    auto addQueueRow = [&](SoloArenaQueueEntry const& entry, uint32 bracket)
+    {
+        SoloArenaSnapshotQueueEntry row;
+        row.Guid = entry.Guid;
+        row.MatchmakerRating = entry.MatchmakerRating;
+        row.Waited = GetMSTimeDiff(entry.JoinTime, now);
+        row.Bracket = uint8(bracket);
+        row.Rated = entry.Rated ? 1 : 0;
+        snapshot.Queue.push_back(row);
+    };
+
+    for (uint32 bracket = BG_BRACKET_ID_FIRST; bracket < MAX_BATTLEGROUND_BRACKETS; ++bracket)
+    {
+        for (SoloArenaQueueEntry const& entry : Queues[bracket].GetEntries())
         {
-            captainName.append(12 - captainName.size(), ' ');
+            addQueueRow(entry, bracket);
         }
+        snapshot.AverageWaits.push_back(Queues[bracket].GetAverageWait(false));
+        snapshot.AverageWaits.push_back(Queues[bracket].GetAverageWait(true));
+    }
+    for (SoloArenaPendingStart const& start : StartScheduler.GetPending())
+    {
+        addQueueRow(start.First, start.Bracket);
+        addQueueRow(start.Second, start.Bracket);
+    }
 
-        auto stats = at->GetStats();
+    std::string error;
+    if (!snapshot.Write(SnapshotFile, error))
+    {
+        TC_LOG_ERROR("bg.arena", "SoloArenaMgr: could not write the snapshot: %s", error.c_str());
+    }
+}
 
-        ChatHandler(player->GetSession()).SendSysMessage(
-            COLOR(color, getCaptainName(at))
-            + " Rating: " + COLOR(color, std::to_string(stats.Rating))
-            + " Wins: " + COLOR(color, std::to_string(stats.SeasonWins))
-            + " Loses: " + COLOR(color, std::to_string(stats.SeasonGames - stats.SeasonWins))
-            + " Weekly Wins: " + COLOR(color, std::to_string(stats.WeekWins))
-            + " Weekly Loses: " + COLOR(color, std::to_string(stats.WeekGames - stats.WeekWins)));
+// Requeues a player of the last snapshot as if they never left, within the bracket their level puts them in now
+void SoloArenaMgr::OnPlayerLogin(Player* player)
+{
+    if (PendingRequeues.empty())
+    {
+        return;
     }
 
-    return true;
+    if (uint32(GameTime::GetGameTime()) > RequeueDeadline)
+    {
+        PendingRequeues.clear();
+        return;
+    }
+
+    auto itr = PendingRequeues.find(player->GetGUID().GetCounter());
+    if (itr == PendingRequeues.end())
+    {
+        return;
+    }
+
+    SoloArenaSnapshotQueueEntry entry = itr->second;
+    PendingRequeues.erase(itr);
+
+    // Same talent and spell restrictions as joining from the gossip menu, the build may have changed while the server was down.
+    if (!Enable || !CheckIfPlayerTalentsAndSpellsAreAllowed(player) || !JoinArenaQueue(player, entry.Rated != 0))
+    {
+        return;
+    }
+
+    uint32 now = GameTime::GetGameTimeMS();
+    uint32 joinTime = now - entry.Waited;
+    if (GroupQueueInfo* ginfo = GetQueuedSoloGroup(player->GetGUID()))
+    {
+        ginfo->JoinTime = joinTime;
+    }
+    for (SoloArenaQueueShard& queue : Queues)
+    {
+        queue.Rejoin(entry.Guid, joinTime, now);
+    }
+
+    ChatHandler(player->GetSession()).PSendSysMessage("You are back in the Solo Arena %s queue, keeping the %u min you waited before the restart.",
+        entry.Rated ? "Rated" : "Skirmish", entry.Waited / MINUTE / IN_MILLISECONDS);
+}
+
+/// <summary>
+/// Season rollover over the struct of arrays ladder.
+/// Inactive teams decay first, reward tiers are taken from the decayed ratings and then ratings are compressed for the next season.
+/// </summary>
+/// <param name="apply">When false nothing is written back, which allows previewing the cutoffs.</param>
+/// <param name="report">Receives the counts, the cutoffs and the time spent in every stage.</param>
+void SoloArenaMgr::RunSeasonRollover(bool apply, SoloArenaSeasonReport& report)
+{
+    typedef std::chrono::steady_clock Clock;
+    auto micros = [](Clock::time_point start) { return uint64(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count()); };
+
+    Clock::time_point start = Clock::now();
+    LoadLadder();
+    size_t count = Ladder.Size();
+    std::vector<uint32> ratings = Ladder.Ratings;
+    report.Teams = uint32(count);
+    report.LoadMicros = micros(start);
+
+    start = Clock::now();
+    SoloArenaKernels::ApplyDecay(ratings.data(), Ladder.SeasonGames.data(), count, SeasonDecayMinGames, SeasonDecayPoints, SeasonDecayFloor);
+    report.Decayed = uint32(SoloArenaKernels::CountDifferent(ratings.data(), Ladder.Ratings.data(), count));
+    report.DecayMicros = micros(start);
+
+    // Cutoffs only consider teams that played enough to be rewarded, best tier first
+    start = Clock::now();
+    std::vector<uint32> eligible;
+    eligible.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (Ladder.SeasonGames[i] >= SeasonRewardMinGames)
+        {
+            eligible.push_back(ratings[i]);
+        }
+    }
+    report.Cutoffs.clear();
+    for (uint32 permille : SeasonRewardCutoffs)
+    {
+        report.Cutoffs.push_back(eligible.empty() ? UINT32_MAX : SoloArenaKernels::FindCutoff(eligible.data(), eligible.size(), permille));
+    }
+    report.CutoffMicros = micros(start);
+
+    start = Clock::now();
+    std::vector<uint8> tiers(count);
+    SoloArenaKernels::AssignTiers(ratings.data(), Ladder.SeasonGames.data(), tiers.data(), count, report.Cutoffs.data(), report.Cutoffs.size(), SeasonRewardMinGames);
+    report.TierCounts.assign(report.Cutoffs.size() + 1, 0);
+    for (uint8 tier : tiers)
+    {
+        ++report.TierCounts[tier];
+    }
+    report.TierMicros = micros(start);
+
+    start = Clock::now();
+    std::vector<uint32> decayed = ratings;
+    SoloArenaKernels::Compress(ratings.data(), count, SeasonCompressBase, SeasonCompressFactor);
+    report.Compressed = uint32(SoloArenaKernels::CountDifferent(ratings.data(), decayed.data(), count));
+    report.CompressMicros = micros(start);
+
+    if (!apply)
+    {
+        return;
+    }
+
+    // Only changed rows are written, in transactions of SeasonBatchSize teams
+    start = Clock::now();
+    CharacterDatabaseTransaction trans = nullptr;
+    uint32 inBatch = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (tiers[i])
+        {
+            TC_LOG_INFO("bg.arena", "Solo Arena season reward: team %u, captain %u, rating %u, tier %u", Ladder.TeamIds[i], Ladder.Captains[i], decayed[i], uint32(tiers[i]));
+        }
+
+        bool resetGames = SeasonResetGames && Ladder.SeasonGames[i] != 0;
+        if (ratings[i] == Ladder.Ratings[i] && !resetGames)
+        {
+            continue;
+        }
+
+        ArenaTeam* team = sArenaTeamMgr->GetArenaTeamById(Ladder.TeamIds[i]);
+        if (!team)
+        {
+            continue;
+        }
+
+        ArenaTeamStats stats = team->GetStats();
+        stats.Rating = ratings[i];
+        if (SeasonResetGames)
+        {
+            stats.SeasonGames = 0;
+            stats.SeasonWins = 0;
+        }
+        team->SetStats(stats);
+
+        if (!trans)
+        {
+            trans = CharacterDatabase.BeginTransaction();
+        }
+
+        // The statements of ArenaTeam::SaveToDB, like FinishRatedSoloMatch
+        CharacterDatabasePreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_UPD_ARENA_TEAM_STATS);
+        stmt->setUInt16(0, stats.Rating);
+        stmt->setUInt16(1, stats.WeekGames);
+        stmt->setUInt16(2, stats.WeekWins);
+        stmt->setUInt16(3, stats.SeasonGames);
+        stmt->setUInt16(4, stats.SeasonWins);
+        stmt->setUInt32(5, stats.Rank);
+        stmt->setUInt32(6, team->GetId());
+        trans->Append(stmt);
+
+        if (ArenaTeamMember* member = team->GetMember(team->GetCaptain()))
+        {
+            member->ModifyPersonalRating(ObjectAccessor::FindPlayer(member->Guid), int32(ratings[i]) - int32(member->PersonalRating), team->GetType());
+            if (SeasonResetGames)
+            {
+                member->SeasonGames = 0;
+                member->SeasonWins = 0;
+            }
+
+            stmt = CharacterDatabase.GetPreparedStatement(CHAR_UPD_ARENA_TEAM_MEMBER);
+            stmt->setUInt16(0, member->PersonalRating);
+            stmt->setUInt16(1, member->WeekGames);
+            stmt->setUInt16(2, member->WeekWins);
+            stmt->setUInt16(3, member->SeasonGames);
+            stmt->setUInt16(4, member->SeasonWins);
+            stmt->setUInt32(5, team->GetId());
+            stmt->setUInt32(6, member->Guid.GetCounter());
+            trans->Append(stmt);
+        }
+
+        // Keeps the snapshot and later passes on the new ratings
+        Ladder.Add(team);
+        team->NotifyStatsChanged();
+        ++report.Written;
+
+        if (++inBatch >= SeasonBatchSize)
+        {
+            CharacterDatabase.CommitTransaction(trans);
+            trans = nullptr;
+            inBatch = 0;
+            ++report.Transactions;
+        }
+    }
+
+    if (trans)
+    {
+        CharacterDatabase.CommitTransaction(trans);
+        ++report.Transactions;
+    }
+    report.WriteMicros = micros(start);
+
+    TC_LOG_INFO("bg.arena", "Solo Arena season rollover: %u teams, %u decayed, %u compressed, %u written in %u transactions.",
+        report.Teams, report.Decayed, report.Compressed, report.Written, report.Transactions);
 }
 
 // Sets up the gossip for the solo arena manager.
@@ -652,17 +2233,21 @@ void SoloArenaMgr::SetupGossip(SimpleGossip* gossip)
     pQueuing = gossip->AddPart();
 
     SimpleGossipOptionIconText* oGoBackToStart;
-    oGoBackToStart = new SimpleGossipOptionIconText(GOSSIP_ICON_INTERACT_1, "Go Back", DONOTHING_ICONTEXT);
+    oGoBackToStart = gossip->NewOption<SimpleGossipOptionIconText>(GOSSIP_ICON_INTERACT_1, "Go Back", DONOTHING_ICONTEXT);
+    oGoBackToStart->GoBack = true;
 
     SimpleGossipOptionIconText* oQueueForSkrimish;
-    oQueueForSkrimish = new SimpleGossipOptionIconText(GOSSIP_ICON_BATTLE, "Queue for Solo Arena Skrimish.", ocQueueForSkrimish);
+    oQueueForSkrimish = gossip->NewOption<SimpleGossipOptionIconText>(GOSSIP_ICON_BATTLE, "Queue for Solo Arena Skrimish.", ocQueueForSkrimish);
     oQueueForSkrimish->ConditionallyShow = ocdIsNotInQueueForSoloArenaO;
+    oQueueForSkrimish->ConditionDependsOn = SIMPLEGOSSIP_STATE_QUEUE;
     SimpleGossipOptionIconText* oQueueForRated;
-    oQueueForRated = new SimpleGossipOptionIconText(GOSSIP_ICON_BATTLE, "Queue for Solo Arena Rated.", ocQueueForRated);
+    oQueueForRated = gossip->NewOption<SimpleGossipOptionIconText>(GOSSIP_ICON_BATTLE, "Queue for Solo Arena Rated.", ocQueueForRated);
     oQueueForRated->ConditionallyShow = ocdRegisterdAndNotInQueueO;
+    oQueueForRated->ConditionDependsOn = SIMPLEGOSSIP_STATE_ARENA_TEAM | SIMPLEGOSSIP_STATE_QUEUE;
     SimpleGossipOptionIconText* oLeaveQueue;
-    oLeaveQueue = new SimpleGossipOptionIconText(GOSSIP_ICON_TAXI, "Leave Arena Queue.", ocLeaveQueue);
+    oLeaveQueue = gossip->NewOption<SimpleGossipOptionIconText>(GOSSIP_ICON_TAXI, "Leave Arena Queue.", ocLeaveQueue);
     oLeaveQueue->ConditionallyShow = ocdIsInQueueForSoloArenaO;
+    oLeaveQueue->ConditionDependsOn = SIMPLEGOSSIP_STATE_QUEUE;
 
     pQueuing->AddOption(oQueueForSkrimish);
     pQueuing->AddOption(oQueueForRated);
@@ -671,18 +2256,19 @@ void SoloArenaMgr::SetupGossip(SimpleGossip* gossip)
     SimpleGossipPart* pGoToRegisterPage;
     pGoToRegisterPage = gossip->AddPart();
     pGoToRegisterPage->ConditionallyShow = ocdIsntPlayerRegisteredP;
+    pGoToRegisterPage->ConditionDependsOn = SIMPLEGOSSIP_STATE_ARENA_TEAM;
     SimpleGossipPart* pRegister;
     pRegister = gossip->AddPart();
 
     SimpleGossipOptionIconText* oGoToRegisterPage;
-    oGoToRegisterPage = new SimpleGossipOptionIconText(GOSSIP_ICON_TALK, "Register for Solo Arena Rated.", DONOTHING_ICONTEXT);
-    oGoToRegisterPage->NextParts = std::vector<uint32>{ pRegister->PartId };
+    oGoToRegisterPage = gossip->NewOption<SimpleGossipOptionIconText>(GOSSIP_ICON_TALK, "Register for Solo Arena Rated.", DONOTHING_ICONTEXT);
+    oGoToRegisterPage->NextParts = { pRegister->PartId };
     SimpleGossipOptionIconTextPopup* oRegisterForRated_Replace2v2;
-    oRegisterForRated_Replace2v2 = new SimpleGossipOptionIconTextPopup(GOSSIP_ICON_TABARD, "Register, Replace 2v2.", "Are you sure you want to Register?", CharterCost, ocRegisterForRated_Replace2v2);
+    oRegisterForRated_Replace2v2 = gossip->NewOption<SimpleGossipOptionIconTextPopup>(GOSSIP_ICON_TABARD, "Register, Replace 2v2.", "Are you sure you want to Register?", CharterCost, ocRegisterForRated_Replace2v2);
     SimpleGossipOptionIconTextPopup* oRegisterForRated_Replace3v3;
-    oRegisterForRated_Replace3v3 = new SimpleGossipOptionIconTextPopup(GOSSIP_ICON_TABARD, "Register, Replace 3v3.", "Are you sure you want to Register?", CharterCost, ocRegisterForRated_Replace3v3);
+    oRegisterForRated_Replace3v3 = gossip->NewOption<SimpleGossipOptionIconTextPopup>(GOSSIP_ICON_TABARD, "Register, Replace 3v3.", "Are you sure you want to Register?", CharterCost, ocRegisterForRated_Replace3v3);
     SimpleGossipOptionIconTextPopup* oRegisterForRated_Replace5v5;
-    oRegisterForRated_Replace5v5 = new SimpleGossipOptionIconTextPopup(GOSSIP_ICON_TABARD, "Register, Replace 5v5.", "Are you sure you want to Register?", CharterCost, ocRegisterForRated_Replace5v5);
+    oRegisterForRated_Replace5v5 = gossip->NewOption<SimpleGossipOptionIconTextPopup>(GOSSIP_ICON_TABARD, "Register, Replace 5v5.", "Are you sure you want to Register?", CharterCost, ocRegisterForRated_Replace5v5);
 
     pGoToRegisterPage->AddOption(oGoToRegisterPage);
     pRegister->AddOption(oRegisterForRated_Replace2v2);
@@ -693,18 +2279,19 @@ void SoloArenaMgr::SetupGossip(SimpleGossip* gossip)
     SimpleGossipPart* pGoToSwapPage;
     pGoToSwapPage = gossip->AddPart();
     pGoToSwapPage->ConditionallyShow = ocdRegisterdAndNotInQueueP;
+    pGoToSwapPage->ConditionDependsOn = SIMPLEGOSSIP_STATE_ARENA_TEAM | SIMPLEGOSSIP_STATE_QUEUE;
     SimpleGossipPart* pSwap;
     pSwap = gossip->AddPart();
 
     SimpleGossipOptionIconText* oGoToSwapRatedPage;
-    oGoToSwapRatedPage = new SimpleGossipOptionIconText(GOSSIP_ICON_CHAT, "Swap Solo Arena Rated Position.", DONOTHING_ICONTEXT);
-    oGoToSwapRatedPage->NextParts = std::vector<uint32>{ pSwap->PartId };
+    oGoToSwapRatedPage = gossip->NewOption<SimpleGossipOptionIconText>(GOSSIP_ICON_CHAT, "Swap Solo Arena Rated Position.", DONOTHING_ICONTEXT);
+    oGoToSwapRatedPage->NextParts = { pSwap->PartId };
     SimpleGossipOptionIconText* oSwapRated_Replace2v2;
-    oSwapRated_Replace2v2 = new SimpleGossipOptionIconText(GOSSIP_ICON_CHAT, "Swap Solo Arena Team with 2v2.", ocSwapRatedReplacement_Replace2v2);
+    oSwapRated_Replace2v2 = gossip->NewOption<SimpleGossipOptionIconText>(GOSSIP_ICON_CHAT, "Swap Solo Arena Team with 2v2.", ocSwapRatedReplacement_Replace2v2);
     SimpleGossipOptionIconText* oSwapRated_Replace3v3;
-    oSwapRated_Replace3v3 = new SimpleGossipOptionIconText(GOSSIP_ICON_CHAT, "Swap Solo Arena Team with 3v3.", ocSwapRatedReplacement_Replace3v3);
+    oSwapRated_Replace3v3 = gossip->NewOption<SimpleGossipOptionIconText>(GOSSIP_ICON_CHAT, "Swap Solo Arena Team with 3v3.", ocSwapRatedReplacement_Replace3v3);
     SimpleGossipOptionIconText* oSwapRated_Replace5v5;
-    oSwapRated_Replace5v5 = new SimpleGossipOptionIconText(GOSSIP_ICON_CHAT, "Swap Solo Arena Team with 5v5.", ocSwapRatedReplacement_Replace5v5);
+    oSwapRated_Replace5v5 = gossip->NewOption<SimpleGossipOptionIconText>(GOSSIP_ICON_CHAT, "Swap Solo Arena Team with 5v5.", ocSwapRatedReplacement_Replace5v5);
 
     pGoToSwapPage->AddOption(oGoToSwapRatedPage);
     pSwap->AddOption(oSwapRated_Replace2v2);
@@ -715,28 +2302,51 @@ void SoloArenaMgr::SetupGossip(SimpleGossip* gossip)
     SimpleGossipPart* pUnregister;
     pUnregister = gossip->AddPart();
     pUnregister->ConditionallyShow = ocdIsPlayerRegisteredP;
+    pUnregister->ConditionDependsOn = SIMPLEGOSSIP_STATE_ARENA_TEAM;
 
     SimpleGossipOptionIconTextPopup* oUnregisterFromRated;
-    oUnregisterFromRated = new SimpleGossipOptionIconTextPopup(GOSSIP_ICON_TALK, "Unregister from Solo Arena Rated.", "Are you sure you want to Unregister?", 0, ocUnregisterFromRated);
+    oUnregisterFromRated = gossip->NewOption<SimpleGossipOptionIconTextPopup>(GOSSIP_ICON_TALK, "Unregister from Solo Arena Rated.", "Are you sure you want to Unregister?", 0, ocUnregisterFromRated);
 
     pUnregister->AddOption(oUnregisterFromRated);
 
     SimpleGossipPart* pStats = gossip->AddPart();
 
     SimpleGossipOptionIconText* oDisplayRatedStatistics;
-    oDisplayRatedStatistics = new SimpleGossipOptionIconText(GOSSIP_ICON_INTERACT_1, "Show My Solo Arena Rated Statistics.", ocDisplayRatedStatistics);
+    oDisplayRatedStatistics = gossip->NewOption<SimpleGossipOptionIconText>(GOSSIP_ICON_INTERACT_1, "Show My Solo Arena Rated Statistics.", ocDisplayRatedStatistics);
     oDisplayRatedStatistics->ConditionallyShow = ocdIsPlayerRegisteredO;
+    oDisplayRatedStatistics->ConditionDependsOn = SIMPLEGOSSIP_STATE_ARENA_TEAM;
+    SimpleGossipOptionIconText* oDisplayRecentMatches;
+    oDisplayRecentMatches = gossip->NewOption<SimpleGossipOptionIconText>(GOSSIP_ICON_INTERACT_1, "Show My Recent Solo Arena Matches.", ocDisplayRecentMatches);
+    oDisplayRecentMatches->ConditionallyShow = ocdIsPlayerRegisteredO;
+    oDisplayRecentMatches->ConditionDependsOn = SIMPLEGOSSIP_STATE_ARENA_TEAM;
     SimpleGossipOptionIconText* oDisplayServerStatistics;
-    oDisplayServerStatistics = new SimpleGossipOptionIconText(GOSSIP_ICON_INTERACT_1, "Show Server Solo Arena Rated Statistics.", ocDisplayServerStatistics);
+    oDisplayServerStatistics = gossip->NewOption<SimpleGossipOptionIconText>(GOSSIP_ICON_INTERACT_1, "Show Server Solo Arena Rated Statistics.", ocDisplayServerStatistics);
 
     pStats->AddOption(oDisplayRatedStatistics);
+    pStats->AddOption(oDisplayRecentMatches);
     pStats->AddOption(oDisplayServerStatistics);
 
+    SimpleGossipPart* pGoToLiveMatches = gossip->AddPart();
+    SimpleGossipPart* pLiveMatches = gossip->AddPart();
+
+    SimpleGossipOptionIconText* oGoToLiveMatches;
+    oGoToLiveMatches = gossip->NewOption<SimpleGossipOptionIconText>(GOSSIP_ICON_BATTLE, "Show Live Solo Arena Matches.", DONOTHING_ICONTEXT);
+    oGoToLiveMatches->NextParts = { pLiveMatches->PartId };
+    SimpleGossipOptionGenerator* oLiveMatches;
+    oLiveMatches = gossip->NewOption<SimpleGossipOptionGenerator>(gLiveMatches, gcLiveMatches);
+    oLiveMatches->PageSize = std::max<uint32>(LiveMatchesShown, 1);
+    oLiveMatches->NextParts = { pLiveMatches->PartId };
+
+    pGoToLiveMatches->AddOption(oGoToLiveMatches);
+    pLiveMatches->AddOption(oLiveMatches);
+    pLiveMatches->AddOption(oGoBackToStart);
+
     SimpleGossipPart* pGoodbye = gossip->AddPart();
 
     SimpleGossipOptionIconText* oGoodbye;
-    oGoodbye = new SimpleGossipOptionIconText(GOSSIP_ICON_INTERACT_1, "Goodbye", DONOTHING_ICONTEXT);
+    oGoodbye = gossip->NewOption<SimpleGossipOptionIconText>(GOSSIP_ICON_INTERACT_1, "Goodbye", DONOTHING_ICONTEXT);
     oGoodbye->CloseDialogOnSelect = true;
+    oGoodbye->RestartOnSelect = false;
 
     pGoodbye->AddOption(oGoodbye);
 
@@ -746,8 +2356,11 @@ void SoloArenaMgr::SetupGossip(SimpleGossip* gossip)
         pGoToSwapPage->PartId,
         pUnregister->PartId,
         pStats->PartId,
+        pGoToLiveMatches->PartId,
         pGoodbye->PartId
     };
+
+    gossip->Finalize();
 }
 
 // Parses the config string seperated by commas and spaces into an array of parsed integers
@@ -781,14 +2394,13 @@ std::vector<uint32> SoloArenaMgr::ParseConfigStringIntoUInt32Array(std::string s
     std::vector<uint32> arr;
 
     // Parse strings to integers and add them to the object
-    std::string tmp;
-    while (ss >> tmp) {
+    for (std::string const& tmp : result) {
         try {
             int value = std::stoi(tmp);
             arr.push_back(value);
         }
         catch (...) {
-            TC_LOG_ERROR("bg.arena", "Unable to parse config value '%u' from string to integer. Make sure comma delimited settings are correct.", tmp);
+            TC_LOG_ERROR("bg.arena", "Unable to parse config value '%s' from string to integer. Make sure comma delimited settings are correct.", tmp.c_str());
         }
     }
 
@@ -806,8 +2418,8 @@ std::unordered_map<uint32, uint32> SoloArenaMgr::MapForbiddenTalentTreeLimits(st
         return map;
     }
 
-    uint8 treeSize = trees.size();
-    for (uint8 i = 0; i < treeSize; i++)
+    uint32 treeSize = trees.size();
+    for (uint32 i = 0; i < treeSize; i++)
     {
         map.insert(std::pair<uint32, uint32>(trees[i], treeLimits[i]));
     }
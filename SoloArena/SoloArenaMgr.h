@@ -4,9 +4,17 @@
 #define _SOLOARENAMGR_H
 
 #include "SimpleGossip.h"
+#include "SoloArenaBrokerClient.h"
+#include "SoloArenaLadder.h"
+#include "SoloArenaMatchHistory.h"
+#include "SoloArenaMatchups.h"
+#include "SoloArenaQueue.h"
+#include "SoloArenaSnapshot.h"
 #include "ArenaTeam.h"
+#include "DBCEnums.h"
 #include <vector>
 #include <unordered_map>
+#include <set>
 #include <string>
 
 enum ArenaTeamType
@@ -23,11 +31,100 @@ enum ArenaTeamSlot
 	THIRD_SLOT = 2
 };
 
+class Battleground;
+class BattlegroundQueue;
+struct GroupQueueInfo;
+
+// The two players of a running 1v1, indexed by TeamId
+struct ActiveSoloMatch
+{
+	ObjectGuid Players[PVP_TEAMS_COUNT];
+	uint32 InstanceId = 0;
+	uint32 Rating[PVP_TEAMS_COUNT] = { };   // Matchmaker ratings, 0 for skrimishes
+	uint32 CombinedRating = 0;
+	uint32 StartTime = 0;                   // Game time the match was made
+	bool Rated = false;
+	bool Listed = false;                    // Made by StartSoloMatch and in LiveMatchesByRating
+	uint8 Tabs[PVP_TEAMS_COUNT] = { SOLO_ARENA_MATCHUP_UNKNOWN_TAB, SOLO_ARENA_MATCHUP_UNKNOWN_TAB };   // Taken when entering the arena
+};
+
+// Scoreboard values of a rated 1v1 finished by SoloArenaMgr, indexed by PvPTeamId like Arena::_arenaTeamScores
+struct SoloArenaFinish
+{
+	int32 RatingChange[PVP_TEAMS_COUNT] = { };
+	uint32 MatchmakerRating[PVP_TEAMS_COUNT] = { };     // Before the match
+	std::string TeamName[PVP_TEAMS_COUNT];
+};
+
+// Combined rating and instance id, best first
+typedef std::set<std::pair<uint32, uint32>, std::greater<std::pair<uint32, uint32>>> SoloArenaLiveMatchIndex;
+
 class TC_GAME_API SoloArenaMgr
 {
 protected:
 	std::vector<uint32> ParseConfigStringIntoUInt32Array(std::string str);
 	std::unordered_map<uint32, uint32> MapForbiddenTalentTreeLimits(std::vector<uint32> trees, std::vector<uint32> treeLimits);
+
+	SoloArenaBrokerClient Broker;
+	uint32 BrokerReconnectTimer = 0;
+	void ConnectToBroker();
+	void ResyncBroker();
+	void HandleBrokerPair(SoloArenaBroker::Pair const& pair);
+	GroupQueueInfo* GetQueuedSoloGroup(ObjectGuid guid);
+	void MoveSoloGroupToTeam(BattlegroundQueue& bgQueue, GroupQueueInfo* ginfo, BattlegroundBracketId bracketId, uint32 team);
+	void UpdateBroker(uint32 diff);
+
+	// Indexed by BattlegroundBracketId, a shard is only ever touched by one matchmaking thread at a time
+	SoloArenaQueueShard Queues[MAX_BATTLEGROUND_BRACKETS];
+	SoloArenaMatchmaker Matchmaker;
+	uint32 MatchmakingTimer = 0;
+	bool MatchmakingPassesRunning = false;      // Some bracket's pass ran out of budget and goes on next update
+	void UpdateMatchmaking(uint32 diff);
+	void RunMatchmaking(bool resumeOnly);
+	// Pairs of the matchmaking passes and the broker, started at most MatchStartsPerUpdate per world update
+	SoloArenaStartScheduler StartScheduler;
+	std::vector<SoloArenaPendingStart> PairedStarts;
+	void StartPendingMatches();
+	void RequeueUnstarted(SoloArenaPendingStart const& start, GroupQueueInfo* first, GroupQueueInfo* second);
+	uint32 QueueStatusTimer = 0;
+	std::vector<SoloArenaQueueStatus> QueueStatusChanges;
+	void PushQueueStatus(uint32 diff);
+	// Invited by StartSoloMatch and still holding their 1v1 queue slot, watched to version the gossip queue state
+	std::vector<ObjectGuid> InvitedPlayers;
+
+	// Keyed by instance id, the matches made by StartSoloMatch are also indexed by combined rating
+	std::unordered_map<uint32, ActiveSoloMatch> ActiveSoloMatches;
+	SoloArenaLiveMatchIndex LiveMatchesByRating;
+	// Last place GetLiveMatchByPlace walked to, UINT32_MAX once the index changed
+	mutable SoloArenaLiveMatchIndex::const_iterator LiveMatchCursor;
+	mutable uint32 LiveMatchCursorPlace = UINT32_MAX;
+	void RegisterLiveMatch(Battleground* arena, GroupQueueInfo* first, GroupQueueInfo* second, bool rated);
+	void UnregisterLiveMatch(uint32 instanceId);
+
+	bool MatchHistoriesLoaded = false;
+	uint32 HistoryFlushTimer = 0;
+	std::unordered_map<uint32, SoloArenaMatchHistory> MatchHistories;
+	std::vector<uint32> DirtyMatchHistories;
+	void LoadMatchHistories();
+	void RecordMatchResult(ObjectGuid guid, SoloArenaMatchResult const& result);
+	void FlushMatchHistories(bool direct);
+
+	bool MatchupsLoaded = false;
+	SoloArenaMatchups Matchups;
+	void LoadMatchups();
+	void FlushMatchups(bool direct);
+
+	// Kept current by registration and rated results once LoadSnapshot ran
+	SoloArenaLadder Ladder;
+	bool LadderLoaded = false;
+	void LoadLadder();
+
+	uint32 SnapshotTimer = 0;
+	// Queued players of the last snapshot, put back into the queue when they log in before RequeueDeadline
+	std::unordered_map<uint32, SoloArenaSnapshotQueueEntry> PendingRequeues;
+	uint32 RequeueDeadline = 0;
+	bool LoadLadderFromSnapshot(SoloArenaSnapshot const& snapshot);
+	void WriteSnapshot();
 public:
 	static SoloArenaMgr* instance();
 
@@ -45,16 +142,53 @@ public:
 	bool EnableForbiddenSpellBlocking;
 	std::vector<uint32> ForbiddenSpells;
 
+	bool UseBroker;
+	std::string BrokerAddress;
+	uint32 BrokerReconnectInterval;
+
+	uint32 MatchmakingThreads;
+	uint32 MatchmakingInterval;
+	uint32 MatchStartsPerUpdate;
+	uint32 MatchmakingBudget;
+	uint32 QueueStatusInterval;
+	bool QueueStatusChat;
+
+	uint32 HistoryFlushInterval;
+	uint32 LiveMatchesShown;
+
+	std::string SnapshotFile;
+	uint32 SnapshotInterval;
+	uint32 SnapshotRequeueWindow;
+
+	uint32 SeasonDecayMinGames;
+	uint32 SeasonDecayPoints;
+	uint32 SeasonDecayFloor;
+	uint32 SeasonCompressBase;
+	float SeasonCompressFactor;
+	std::vector<uint32> SeasonRewardCutoffs;
+	uint32 SeasonRewardMinGames;
+	bool SeasonResetGames;
+	uint32 SeasonBatchSize;
+
 	bool CheckIfPlayerTalentsAndSpellsAreAllowed(Player* player);
 	void InitializeSoloArenaMgr();
 	void SetupGossip(SimpleGossip* gossip);
+	void Update(uint32 diff);
+	void Shutdown();
+	void LoadSnapshot();
+	void OnPlayerLogin(Player* player);
+	// Also answers CMSG_BATTLEFIELD_STATUS for queued 1v1 players, see the core diff
+	void SendQueueStatus(Player* player, uint32 queueSlot, uint32 avgTime, bool rated, uint32 timeInQueue = 0);
 
 	bool QueueForSkrimish(Player* player);
 	bool QueueForRated(Player* player);
 	bool JoinArenaQueue(Player* player, bool rated);
 	bool LeaveQueue(Player* player);
+	bool HandlesMatchmaking();
+	bool StartSoloMatch(GroupQueueInfo* first, GroupQueueInfo* second, BattlegroundBracketId bracketId, bool rated);
 
 	bool IsPlayerRegistered(Player* player);
+	bool IsSoloArenaTeam(ArenaTeam* team);
 	ArenaTeam* GetSoloArenaTeam(Player* player);
 	std::string GetSoloArenaTeamNameForPlayer(std::string playerName);
 
@@ -64,6 +198,34 @@ public:
 
 	bool DisplayRatedStatistics(Player* player);
 	bool DisplayServerStatistics(Player* player);
+	bool DisplayRecentMatches(Player* player);
+	bool DisplayLiveMatch(Player* player, uint32 place);
+
+	ActiveSoloMatch const* GetLiveMatch(uint32 instanceId) const;
+	ActiveSoloMatch const* GetLiveMatchByPlace(uint32 place) const;
+	size_t GetLiveMatchCount() const { return LiveMatchesByRating.size(); }
+	std::string DescribeLiveMatch(ActiveSoloMatch const& match) const;
+	bool SpectateLiveMatch(Player* player, uint32 instanceId);
+
+	SoloArenaMatchmakingStats const& GetMatchmakingStats(uint32 bracket) const { return Queues[bracket].GetStats(); }
+
+	static uint8 GetMatchupTab(Player* player);
+	SoloArenaMatchups const& GetMatchups() const { return Matchups; }
+
+	// Calls f with the count highest rated live matches, best first
+	template<class F>
+	void ForEachTopLiveMatch(uint32 count, F&& f) const
+	{
+		for (auto itr = LiveMatchesByRating.begin(); itr != LiveMatchesByRating.end() && count; ++itr, --count)
+			f(ActiveSoloMatches.at(itr->second));
+	}
+
+	void RunSeasonRollover(bool apply, SoloArenaSeasonReport& report);
+
+	void OnSoloPlayerAdded(Battleground* bg, Player* player);
+	bool FinishRatedSoloMatch(Battleground* bg, uint32 winner, SoloArenaFinish& finish);
+	void OnSoloMatchEnd(Battleground* bg, uint32 winner, int32 allianceRatingChange, int32 hordeRatingChange);
+	void OnSoloArenaDeleted(Battleground* bg);
 };
 
 #define sSoloArenaMgr SoloArenaMgr::instance()
@@ -0,0 +1,439 @@
+// This code is licensed under MIT license
+
+#include "SoloArenaQueue.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+    // Steps between two looks at the clock, sorting a run counts as one step per entry
+    constexpr uint32 STEPS_PER_CLOCK_CHECK = 256;
+    constexpr size_t SORT_RUN_LENGTH = 64;
+}
+
+void SoloArenaQueueShard::Add(SoloArenaQueueEntry const& entry)
+{
+    Remove(entry.Guid);
+    Entries.push_back(entry);
+}
+
+bool SoloArenaQueueShard::Remove(uint32 guid)
+{
+    auto itr = std::find_if(Entries.begin(), Entries.end(), [guid](SoloArenaQueueEntry const& entry) { return entry.Guid == guid; });
+    if (itr == Entries.end())
+        return false;
+
+    Entries.erase(itr);
+    return true;
+}
+
+// Entries stay in join order, so the entry is rotated in front of the first one that waited less
+bool SoloArenaQueueShard::Rejoin(uint32 guid, uint32 joinTime, uint32 now)
+{
+    auto itr = std::find_if(Entries.begin(), Entries.end(), [guid](SoloArenaQueueEntry const& entry) { return entry.Guid == guid; });
+    if (itr == Entries.end())
+        return false;
+
+    itr->JoinTime = joinTime;
+    itr->SentPosition = 0;
+
+    uint32 waited = now - joinTime;
+    auto place = std::find_if(Entries.begin(), itr, [now, waited](SoloArenaQueueEntry const& entry) { return now - entry.JoinTime < waited; });
+    std::rotate(place, itr, itr + 1);
+    return true;
+}
+
+bool SoloArenaQueueShard::Contains(uint32 guid) const
+{
+    return std::any_of(Entries.begin(), Entries.end(), [guid](SoloArenaQueueEntry const& entry) { return entry.Guid == guid; });
+}
+
+bool SoloArenaQueueShard::Take(uint32 guid, SoloArenaQueueEntry& entry)
+{
+    auto itr = std::find_if(Entries.begin(), Entries.end(), [guid](SoloArenaQueueEntry const& queued) { return queued.Guid == guid; });
+    if (itr == Entries.end())
+        return false;
+
+    entry = *itr;
+    Entries.erase(itr);
+    return true;
+}
+
+// The remaining entries keep their join order
+void SoloArenaQueueShard::TakePairs(std::vector<SoloArenaPendingStart>& starts)
+{
+    if (Pairs.empty())
+        return;
+
+    std::unordered_map<uint32, size_t> slots;
+    slots.reserve(Pairs.size() * 2);
+    for (size_t i = 0; i < Pairs.size(); ++i)
+    {
+        slots[Pairs[i].First] = i * 2;
+        slots[Pairs[i].Second] = i * 2 + 1;
+    }
+
+    // The pass may have been split over several updates, a pair only starts when both players are still queued the same way
+    std::vector<SoloArenaQueueEntry> paired(Pairs.size() * 2);
+    std::vector<uint8> found(Pairs.size(), 0);
+    for (SoloArenaQueueEntry const& entry : Entries)
+    {
+        auto itr = slots.find(entry.Guid);
+        if (itr == slots.end() || entry.Rated != Pairs[itr->second / 2].Rated)
+            continue;
+
+        paired[itr->second] = entry;
+        ++found[itr->second / 2];
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < Entries.size(); ++i)
+    {
+        auto itr = slots.find(Entries[i].Guid);
+        if (itr == slots.end() || found[itr->second / 2] != 2)
+            Entries[kept++] = Entries[i];
+    }
+    Entries.resize(kept);
+
+    for (size_t i = 0; i < Pairs.size(); ++i)
+    {
+        if (found[i] != 2)
+            continue;
+
+        SoloArenaPendingStart start;
+        start.First = paired[i * 2];
+        start.Second = paired[i * 2 + 1];
+        start.Rated = Pairs[i].Rated;
+        starts.push_back(start);
+    }
+    Pairs.clear();
+}
+
+bool SoloArenaQueueShard::FindPairs(uint32 now, SoloArenaMatchmakingSettings const& settings, Clock::time_point deadline, bool resumeOnly)
+{
+    if (Stage == PASS_IDLE)
+    {
+        if (resumeOnly)
+            return true;
+
+        if (Entries.size() < 2)
+        {
+            Pairs.clear();
+            return true;
+        }
+
+        // Copying is the only part of a pass that isn't budgeted, it is one pass over the entries
+        PassNow = now;
+        PassSettings = settings;
+        PassEntries = Entries;
+        PassPairs.clear();
+        Rated.clear();
+        Cursor = 0;
+        WaitingSkirmish = 0;
+        PassSlices = 0;
+        Stage = PASS_SKIRMISH;
+    }
+
+    Clock::time_point start = Clock::now();
+    Steps = 0;
+    bool done = RunPass(deadline);
+
+    ++PassSlices;
+    ++Stats.Slices;
+    Stats.Micros += uint64(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+    if (!done)
+        return false;
+
+    Stage = PASS_IDLE;
+    Pairs.swap(PassPairs);
+    ++Stats.Passes;
+    if (PassSlices > 1)
+        ++Stats.SplitPasses;
+    Stats.MaxSlices = std::max(Stats.MaxSlices, PassSlices);
+    return true;
+}
+
+// Every slice does at least STEPS_PER_CLOCK_CHECK steps, so a pass always finishes however small the budget is
+bool SoloArenaQueueShard::OutOfTime(Clock::time_point deadline, uint32 steps)
+{
+    Steps += steps;
+    if (Steps < STEPS_PER_CLOCK_CHECK)
+        return false;
+
+    Steps = 0;
+    return deadline != Clock::time_point::max() && Clock::now() >= deadline;
+}
+
+bool SoloArenaQueueShard::RunPass(Clock::time_point deadline)
+{
+    auto lowerRating = [this](uint32 a, uint32 b) { return PassEntries[a].MatchmakerRating < PassEntries[b].MatchmakerRating; };
+
+    switch (Stage)
+    {
+        case PASS_SKIRMISH:
+            while (Cursor < PassEntries.size())
+            {
+                uint32 index = uint32(Cursor++);
+                SoloArenaQueueEntry const& entry = PassEntries[index];
+                if (entry.Rated)
+                    Rated.push_back(index);
+                else if (!WaitingSkirmish)
+                    WaitingSkirmish = entry.Guid;
+                else
+                {
+                    PassPairs.push_back({ WaitingSkirmish, entry.Guid, false });
+                    WaitingSkirmish = 0;
+                }
+
+                if (OutOfTime(deadline))
+                    return false;
+            }
+
+            Stage = PASS_SORT_RUNS;
+            Cursor = 0;
+            [[fallthrough]];
+        case PASS_SORT_RUNS:
+            // Neighbours by rating, stable so equal ratings keep their join order
+            while (Cursor < Rated.size())
+            {
+                size_t end = std::min(Cursor + SORT_RUN_LENGTH, Rated.size());
+                std::stable_sort(Rated.begin() + Cursor, Rated.begin() + end, lowerRating);
+                Cursor = end;
+
+                if (OutOfTime(deadline, SORT_RUN_LENGTH))
+                    return false;
+            }
+
+            Stage = PASS_SORT_MERGE;
+            MergeBuffer.resize(Rated.size());
+            MergeWidth = SORT_RUN_LENGTH;
+            MergeLeft = 0;
+            MergeOut = 0;
+            [[fallthrough]];
+        case PASS_SORT_MERGE:
+            if (!MergeRuns(deadline))
+                return false;
+
+            Stage = PASS_RATED;
+            Cursor = 0;
+            [[fallthrough]];
+        case PASS_RATED:
+        {
+            auto waitedLongEnough = [this](SoloArenaQueueEntry const& entry)
+            {
+                return PassSettings.RatingDiscardTime && PassNow - entry.JoinTime >= PassSettings.RatingDiscardTime;
+            };
+
+            while (Cursor + 1 < Rated.size())
+            {
+                SoloArenaQueueEntry const& low = PassEntries[Rated[Cursor]];
+                SoloArenaQueueEntry const& high = PassEntries[Rated[Cursor + 1]];
+                if (!PassSettings.MaxRatingDifference || high.MatchmakerRating - low.MatchmakerRating <= PassSettings.MaxRatingDifference
+                    || waitedLongEnough(low) || waitedLongEnough(high))
+                {
+                    PassPairs.push_back({ low.Guid, high.Guid, true });
+                    Cursor += 2;
+                }
+                else
+                    ++Cursor;
+
+                if (OutOfTime(deadline))
+                    return false;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return true;
+}
+
+// Bottom up merge of the sorted runs through MergeBuffer, one element per step.
+// A merge starts whenever MergeOut reached MergeLeft, otherwise a suspended one is continued.
+bool SoloArenaQueueShard::MergeRuns(Clock::time_point deadline)
+{
+    size_t size = Rated.size();
+    while (MergeWidth < size)
+    {
+        while (MergeLeft < size)
+        {
+            size_t middle = std::min(MergeLeft + MergeWidth, size);
+            size_t end = std::min(MergeLeft + MergeWidth * 2, size);
+            if (MergeOut == MergeLeft)
+            {
+                MergeI = MergeLeft;
+                MergeJ = middle;
+            }
+
+            while (MergeOut < end)
+            {
+                // Ties are taken from the left run first, which keeps the sort stable
+                if (MergeJ >= end || (MergeI < middle && PassEntries[Rated[MergeJ]].MatchmakerRating >= PassEntries[Rated[MergeI]].MatchmakerRating))
+                    MergeBuffer[MergeOut++] = Rated[MergeI++];
+                else
+                    MergeBuffer[MergeOut++] = Rated[MergeJ++];
+
+                if (OutOfTime(deadline))
+                    return false;
+            }
+            MergeLeft = end;
+        }
+
+        Rated.swap(MergeBuffer);
+        MergeWidth *= 2;
+        MergeLeft = 0;
+        MergeOut = 0;
+    }
+    return true;
+}
+
+void SoloArenaQueueShard::RecordWait(bool rated, uint32 wait)
+{
+    uint32& average = AverageWait[rated ? 1 : 0];
+    average = average ? uint32((uint64(average) * 7 + wait) / 8) : wait;
+}
+
+void SoloArenaQueueShard::CollectStatusChanges(uint32 now, std::vector<SoloArenaQueueStatus>& changes)
+{
+    uint32 waiting[2] = { };
+    for (SoloArenaQueueEntry const& entry : Entries)
+        ++waiting[entry.Rated ? 1 : 0];
+
+    uint32 position[2] = { };
+    for (SoloArenaQueueEntry& entry : Entries)
+    {
+        uint32 kind = entry.Rated ? 1 : 0;
+        ++position[kind];
+        uint32 estimate = (AverageWait[kind] + 59999) / 60000 * 60000;
+        if (entry.SentPosition == position[kind] && entry.SentWait == estimate)
+            continue;
+
+        entry.SentPosition = position[kind];
+        entry.SentWait = estimate;
+
+        SoloArenaQueueStatus status;
+        status.Guid = entry.Guid;
+        status.Position = position[kind];
+        status.Waiting = waiting[kind];
+        status.EstimatedWait = estimate;
+        status.TimeInQueue = now - entry.JoinTime;
+        status.Rated = entry.Rated;
+        changes.push_back(status);
+    }
+}
+
+void SoloArenaStartScheduler::EndPass(uint32 now)
+{
+    if (Batch.empty())
+        return;
+
+    auto longestWait = [now](SoloArenaPendingStart const& start) { return std::max(now - start.First.JoinTime, now - start.Second.JoinTime); };
+    std::stable_sort(Batch.begin(), Batch.end(), [&](SoloArenaPendingStart const& a, SoloArenaPendingStart const& b) { return longestWait(a) > longestWait(b); });
+
+    Pending.insert(Pending.end(), Batch.begin(), Batch.end());
+    Batch.clear();
+}
+
+bool SoloArenaStartScheduler::Pop(SoloArenaPendingStart& start)
+{
+    if (Pending.empty())
+        return false;
+
+    start = Pending.front();
+    Pending.pop_front();
+    return true;
+}
+
+void SoloArenaMatchmaker::Start(uint32 threads)
+{
+    Stop();
+
+    Stopping = false;
+    for (uint32 i = 0; i < threads; ++i)
+        Workers.emplace_back(&SoloArenaMatchmaker::WorkerThread, this);
+}
+
+void SoloArenaMatchmaker::Stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(Lock);
+        Stopping = true;
+    }
+    WorkReady.notify_all();
+
+    for (std::thread& worker : Workers)
+        worker.join();
+    Workers.clear();
+}
+
+void SoloArenaMatchmaker::Run(SoloArenaQueueShard* shards, size_t count, uint32 now, SoloArenaMatchmakingSettings const& settings, bool resumeOnly)
+{
+    if (!count)
+        return;
+
+    SoloArenaQueueShard::Clock::time_point deadline = SoloArenaQueueShard::Clock::time_point::max();
+    if (settings.BudgetMicros)
+        deadline = SoloArenaQueueShard::Clock::now() + std::chrono::microseconds(settings.BudgetMicros);
+
+    size_t first = FirstShard;
+    FirstShard = (FirstShard + 1) % count;
+
+    if (Workers.empty())
+    {
+        for (size_t i = 0; i < count; ++i)
+            shards[(first + i) % count].FindPairs(now, settings, deadline, resumeOnly);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(Lock);
+        Shards = shards;
+        ShardCount = count;
+        Now = now;
+        Settings = settings;
+        Deadline = deadline;
+        ResumeOnly = resumeOnly;
+        StartShard = first;
+        NextShard = 0;
+        ++Generation;
+    }
+    WorkReady.notify_all();
+
+    RunShards();
+
+    // Workers that woke up late may still be finishing a shard, nothing may change them until they are all idle
+    std::unique_lock<std::mutex> guard(Lock);
+    WorkDone.wait(guard, [this] { return Busy == 0 && NextShard >= ShardCount; });
+    Shards = nullptr;
+}
+
+void SoloArenaMatchmaker::RunShards()
+{
+    for (size_t i = NextShard++; i < ShardCount; i = NextShard++)
+        Shards[(StartShard + i) % ShardCount].FindPairs(Now, Settings, Deadline, ResumeOnly);
+}
+
+void SoloArenaMatchmaker::WorkerThread()
+{
+    uint64 seenGeneration = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> guard(Lock);
+            WorkReady.wait(guard, [&] { return Stopping || Generation != seenGeneration; });
+            if (Stopping)
+                return;
+
+            seenGeneration = Generation;
+            ++Busy;
+        }
+
+        RunShards();
+
+        {
+            std::lock_guard<std::mutex> guard(Lock);
+            --Busy;
+        }
+        WorkDone.notify_all();
+    }
+}
@@ -0,0 +1,231 @@
+// This code is licensed under MIT license
+
+#ifndef _SOLOARENAQUEUE_H
+#define _SOLOARENAQUEUE_H
+
+#include "Define.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct SoloArenaQueueEntry
+{
+    uint32 Guid = 0;                // player guid counter
+    uint32 MatchmakerRating = 0;
+    uint32 JoinTime = 0;            // game time in ms
+    bool Rated = false;
+    uint32 SentPosition = 0;        // last status pushed to the player, 0 before the first
+    uint32 SentWait = 0;
+};
+
+// A queued player whose position or estimated wait changed since the last status push
+struct SoloArenaQueueStatus
+{
+    uint32 Guid = 0;
+    uint32 Position = 0;            // 1 based, in join order among the entries of the same kind
+    uint32 Waiting = 0;             // entries of the same kind
+    uint32 EstimatedWait = 0;       // ms, whole minutes so the estimate doesn't change on every pass
+    uint32 TimeInQueue = 0;         // ms
+    bool Rated = false;
+};
+
+struct SoloArenaQueuePair
+{
+    uint32 First = 0;
+    uint32 Second = 0;
+    bool Rated = false;
+};
+
+// A pair waiting for SoloArenaStartScheduler to start its match, with the queue entries to put back if it can't
+struct SoloArenaPendingStart
+{
+    SoloArenaQueueEntry First;
+    SoloArenaQueueEntry Second;
+    uint32 Bracket = 0;
+    bool Rated = false;
+};
+
+struct SoloArenaMatchmakingSettings
+{
+    uint32 MaxRatingDifference = 0;     // 0 means any rating difference is fine
+    uint32 RatingDiscardTime = 0;       // ms, after waiting this long the rating difference is ignored, 0 never
+    uint32 BudgetMicros = 0;            // time a Run may spend before passes are suspended, 0 unlimited
+};
+
+// Counted per shard by its passes, a pass is split when it needed more than one slice
+struct SoloArenaMatchmakingStats
+{
+    uint64 Passes = 0;
+    uint64 SplitPasses = 0;
+    uint64 Slices = 0;
+    uint32 MaxSlices = 0;               // slices of the longest pass
+    uint64 Micros = 0;                  // spent in all slices
+
+    void Add(SoloArenaMatchmakingStats const& other)
+    {
+        Passes += other.Passes;
+        SplitPasses += other.SplitPasses;
+        Slices += other.Slices;
+        MaxSlices = std::max(MaxSlices, other.MaxSlices);
+        Micros += other.Micros;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// The 1v1 queue of one bracket.
+// Entries are only changed by the world thread, FindPairs only reads them and fills the
+// shard's own pair list, so every bracket can be matched on a different thread.
+// A pass may be split over several world updates, it then works on the entries it started
+// with and TakePairs drops the pairs whose players changed since.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SoloArenaQueueShard
+{
+public:
+    // Replaces the entry of a player who is already queued
+    void Add(SoloArenaQueueEntry const& entry);
+    bool Remove(uint32 guid);
+    // Moves a queued player back to the place their join time earns, for entries restored after a restart
+    bool Rejoin(uint32 guid, uint32 joinTime, uint32 now);
+    bool Contains(uint32 guid) const;
+    // Removes a player's entry and hands it out
+    bool Take(uint32 guid, SoloArenaQueueEntry& entry);
+    // Removes the entries of every pair of the last finished pass and appends their starts, Bracket is left to the caller.
+    // Pairs of which a player left since the pass started are dropped and the other player keeps waiting.
+    void TakePairs(std::vector<SoloArenaPendingStart>& starts);
+    size_t Size() const { return Entries.size(); }
+    void Clear() { Entries.clear(); Pairs.clear(); PassPairs.clear(); Stage = PASS_IDLE; }
+
+    template<class P>
+    size_t RemoveIf(P pred)
+    {
+        size_t before = Entries.size();
+        Entries.erase(std::remove_if(Entries.begin(), Entries.end(), pred), Entries.end());
+        return before - Entries.size();
+    }
+
+    std::vector<SoloArenaQueueEntry> const& GetEntries() const { return Entries; }
+    std::vector<SoloArenaQueuePair> const& GetPairs() const { return Pairs; }
+
+    typedef std::chrono::steady_clock Clock;
+
+    // Skirmish entries are paired in join order, rated entries with their closest rating.
+    // A pass that reaches the deadline is suspended and the next call resumes it with the now and settings it started with,
+    // returns true once the pass finished and its pairs replaced GetPairs. resumeOnly doesn't start a new pass.
+    bool FindPairs(uint32 now, SoloArenaMatchmakingSettings const& settings, Clock::time_point deadline = Clock::time_point::max(), bool resumeOnly = false);
+    bool IsPassRunning() const { return Stage != PASS_IDLE; }
+    SoloArenaMatchmakingStats const& GetStats() const { return Stats; }
+
+    // How long a matched player waited, the estimates are a moving average of these
+    void RecordWait(bool rated, uint32 wait);
+    uint32 GetAverageWait(bool rated) const { return AverageWait[rated ? 1 : 0]; }
+    void SetAverageWait(bool rated, uint32 wait) { AverageWait[rated ? 1 : 0] = wait; }
+    // One pass over the entries, appends those whose position or estimate changed since the last call
+    void CollectStatusChanges(uint32 now, std::vector<SoloArenaQueueStatus>& changes);
+
+private:
+    enum PassStage : uint8
+    {
+        PASS_IDLE,
+        PASS_SKIRMISH,                          // pairs skirmish entries, collects the rated ones
+        PASS_SORT_RUNS,                         // sorts short runs of the rated entries
+        PASS_SORT_MERGE,                        // merges the runs bottom up
+        PASS_RATED                              // pairs rating neighbours
+    };
+
+    bool RunPass(Clock::time_point deadline);
+    bool MergeRuns(Clock::time_point deadline);
+    bool OutOfTime(Clock::time_point deadline, uint32 steps = 1);
+
+    std::vector<SoloArenaQueueEntry> Entries;   // join order
+    std::vector<SoloArenaQueuePair> Pairs;
+    uint32 AverageWait[2] = { };                // ms, skirmish and rated
+
+    // The running pass works on a copy of the entries taken when it started, so the world thread may change them meanwhile
+    PassStage Stage = PASS_IDLE;
+    uint32 PassNow = 0;
+    SoloArenaMatchmakingSettings PassSettings;
+    std::vector<SoloArenaQueueEntry> PassEntries;
+    std::vector<SoloArenaQueuePair> PassPairs;
+    std::vector<uint32> Rated;                  // indexes into PassEntries
+    std::vector<uint32> MergeBuffer;
+    size_t Cursor = 0;
+    uint32 WaitingSkirmish = 0;
+    size_t MergeWidth = 0;
+    size_t MergeLeft = 0;
+    size_t MergeI = 0;
+    size_t MergeJ = 0;
+    size_t MergeOut = 0;
+    uint32 Steps = 0;
+    uint32 PassSlices = 0;
+    SoloArenaMatchmakingStats Stats;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Pairs waiting for their match to start, so a pass pairing many players at once doesn't
+// create all their arenas in the same world update. Pairs found by earlier passes start
+// first, the pairs of one pass start by how long their longest waiting player waited,
+// whatever bracket they are in.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SoloArenaStartScheduler
+{
+public:
+    void Add(SoloArenaPendingStart const& start) { Batch.push_back(start); }
+    // Orders the pairs added since the last call and puts them behind those already waiting
+    void EndPass(uint32 now);
+    bool Pop(SoloArenaPendingStart& start);
+    size_t Size() const { return Pending.size() + Batch.size(); }
+    void Clear() { Pending.clear(); Batch.clear(); }
+
+    std::deque<SoloArenaPendingStart> const& GetPending() const { return Pending; }
+
+private:
+    std::deque<SoloArenaPendingStart> Pending;
+    std::vector<SoloArenaPendingStart> Batch;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Small fork/join pool running FindPairs over a set of shards.
+// Run hands out one shard at a time to the workers and the calling thread, and only
+// returns once every shard is done or suspended. Without workers the shards are matched inline.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SoloArenaMatchmaker
+{
+public:
+    ~SoloArenaMatchmaker() { Stop(); }
+
+    void Start(uint32 threads);
+    void Stop();
+    uint32 GetThreadCount() const { return uint32(Workers.size()); }
+
+    // Runs or resumes the pass of every shard until settings.BudgetMicros is used up. resumeOnly only resumes suspended passes.
+    void Run(SoloArenaQueueShard* shards, size_t count, uint32 now, SoloArenaMatchmakingSettings const& settings, bool resumeOnly = false);
+
+private:
+    void WorkerThread();
+    void RunShards();
+
+    std::vector<std::thread> Workers;
+    std::mutex Lock;
+    std::condition_variable WorkReady;
+    std::condition_variable WorkDone;
+    uint64 Generation = 0;
+    uint32 Busy = 0;
+    bool Stopping = false;
+
+    SoloArenaQueueShard* Shards = nullptr;
+    size_t ShardCount = 0;
+    uint32 Now = 0;
+    SoloArenaMatchmakingSettings Settings;
+    SoloArenaQueueShard::Clock::time_point Deadline;
+    bool ResumeOnly = false;
+    size_t StartShard = 0;
+    size_t FirstShard = 0;              // rotates, so the shards a budget runs out on aren't always the same
+    std::atomic<size_t> NextShard{ 0 };
+};
+
+#endif
@@ -0,0 +1,168 @@
+// This code is licensed under MIT license
+
+#include "SoloArenaSnapshot.h"
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace
+{
+    struct SnapshotHeader
+    {
+        uint32 Magic = SOLO_ARENA_SNAPSHOT_MAGIC;
+        uint32 Version = SOLO_ARENA_SNAPSHOT_VERSION;
+        uint32 Checksum = 0;                // of everything after the header
+        uint32 WrittenAt = 0;
+        uint32 ArenaTeamCount = 0;
+        uint32 ArenaTeamMemberCount = 0;
+        uint32 TeamCount = 0;
+        uint32 QueueCount = 0;
+        uint32 AverageWaitCount = 0;
+    };
+
+    static_assert(std::is_trivially_copyable<SnapshotHeader>::value, "snapshot rows are copied as bytes");
+    static_assert(std::is_trivially_copyable<SoloArenaSnapshotTeam>::value, "snapshot rows are copied as bytes");
+    static_assert(std::is_trivially_copyable<SoloArenaSnapshotQueueEntry>::value, "snapshot rows are copied as bytes");
+    static_assert(sizeof(SoloArenaSnapshotQueueEntry) == 16, "snapshot rows must not change size without a version bump");
+
+    // FNV-1a, continued over every table
+    uint32 Checksum(uint32 hash, void const* data, size_t size)
+    {
+        uint8 const* bytes = static_cast<uint8 const*>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 16777619u;
+        return hash;
+    }
+
+    template<class T>
+    uint32 ChecksumTable(uint32 hash, std::vector<T> const& table)
+    {
+        return table.empty() ? hash : Checksum(hash, table.data(), table.size() * sizeof(T));
+    }
+
+    template<class T>
+    void WriteTable(std::ofstream& out, std::vector<T> const& table)
+    {
+        if (!table.empty())
+            out.write(reinterpret_cast<char const*>(table.data()), std::streamsize(table.size() * sizeof(T)));
+    }
+
+    // The mapping has no alignment guarantees for the rows, so they are copied out
+    template<class T>
+    void ReadTable(char const*& data, uint32 count, std::vector<T>& table)
+    {
+        table.resize(count);
+        if (count)
+            std::memcpy(table.data(), data, count * sizeof(T));
+        data += count * sizeof(T);
+    }
+}
+
+bool SoloArenaSnapshot::Write(std::string const& path, std::string& error) const
+{
+    SnapshotHeader header;
+    header.WrittenAt = WrittenAt;
+    header.ArenaTeamCount = ArenaTeamCount;
+    header.ArenaTeamMemberCount = ArenaTeamMemberCount;
+    header.TeamCount = uint32(Teams.size());
+    header.QueueCount = uint32(Queue.size());
+    header.AverageWaitCount = uint32(AverageWaits.size());
+    header.Checksum = ChecksumTable(ChecksumTable(ChecksumTable(2166136261u, Teams), Queue), AverageWaits);
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            error = "cannot open " + temporary;
+            return false;
+        }
+
+        out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        WriteTable(out, Teams);
+        WriteTable(out, Queue);
+        WriteTable(out, AverageWaits);
+        out.flush();
+        if (!out)
+        {
+            error = "cannot write " + temporary;
+            return false;
+        }
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::rename(temporary, path, ec);
+    if (ec)
+    {
+        error = "cannot replace " + path + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+bool SoloArenaSnapshot::Read(std::string const& path, std::string& error)
+{
+    boost::system::error_code ec;
+    if (!boost::filesystem::exists(path, ec))
+    {
+        error = "no snapshot at " + path;
+        return false;
+    }
+
+    boost::iostreams::mapped_file_source file;
+    try
+    {
+        file.open(path);
+    }
+    catch (std::exception const& e)
+    {
+        error = "cannot map " + path + ": " + e.what();
+        return false;
+    }
+
+    if (file.size() < sizeof(SnapshotHeader))
+    {
+        error = "snapshot is truncated";
+        return false;
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.Magic != SOLO_ARENA_SNAPSHOT_MAGIC)
+    {
+        error = "not a Solo Arena snapshot";
+        return false;
+    }
+    if (header.Version != SOLO_ARENA_SNAPSHOT_VERSION)
+    {
+        error = "snapshot version " + std::to_string(header.Version) + " is not " + std::to_string(SOLO_ARENA_SNAPSHOT_VERSION);
+        return false;
+    }
+
+    uint64 expected = sizeof(SnapshotHeader)
+        + uint64(header.TeamCount) * sizeof(SoloArenaSnapshotTeam)
+        + uint64(header.QueueCount) * sizeof(SoloArenaSnapshotQueueEntry)
+        + uint64(header.AverageWaitCount) * sizeof(uint32);
+    if (file.size() != expected)
+    {
+        error = "snapshot size does not match its tables";
+        return false;
+    }
+
+    char const* data = file.data() + sizeof(SnapshotHeader);
+    if (Checksum(2166136261u, data, size_t(expected - sizeof(SnapshotHeader))) != header.Checksum)
+    {
+        error = "snapshot checksum mismatch";
+        return false;
+    }
+
+    WrittenAt = header.WrittenAt;
+    ArenaTeamCount = header.ArenaTeamCount;
+    ArenaTeamMemberCount = header.ArenaTeamMemberCount;
+    ReadTable(data, header.TeamCount, Teams);
+    ReadTable(data, header.QueueCount, Queue);
+    ReadTable(data, header.AverageWaitCount, AverageWaits);
+    return true;
+}
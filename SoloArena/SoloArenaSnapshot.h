@@ -0,0 +1,53 @@
+// This code is licensed under MIT license
+
+#ifndef _SOLOARENASNAPSHOT_H
+#define _SOLOARENASNAPSHOT_H
+
+#include "Define.h"
+#include <string>
+#include <vector>
+
+// Bump whenever a row or the header changes, older snapshots are then ignored
+constexpr uint32 SOLO_ARENA_SNAPSHOT_VERSION = 2;
+constexpr uint32 SOLO_ARENA_SNAPSHOT_MAGIC = 0x50534153;   // "SASP"
+
+struct SoloArenaSnapshotTeam
+{
+    uint32 TeamId = 0;
+    uint32 Captain = 0;         // guid counter, checked against the loaded team
+    uint32 Rating = 0;
+};
+
+struct SoloArenaSnapshotQueueEntry
+{
+    uint32 Guid = 0;            // player guid counter
+    uint32 MatchmakerRating = 0;
+    uint32 Waited = 0;          // ms spent in the queue when the snapshot was written
+    uint8 Bracket = 0;
+    uint8 Rated = 0;
+    uint16 Padding = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Derived Solo Arena state written on shutdown and periodically, so a restart neither has
+// to find the solo teams among all arena teams by name nor empties the 1v1 queue.
+// The file is a header followed by the tables as fixed size rows in native byte order,
+// it is mapped on load and only accepted when magic, version, sizes and checksum match.
+// Whether it still fits the database is up to the caller, the row counts help with that.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SoloArenaSnapshot
+{
+public:
+    uint32 WrittenAt = 0;                   // unix time
+    uint32 ArenaTeamCount = 0;              // every arena team, solo or not, when written
+    uint32 ArenaTeamMemberCount = 0;        // members of every arena team when written
+    std::vector<SoloArenaSnapshotTeam> Teams;                   // solo teams, best rating first
+    std::vector<SoloArenaSnapshotQueueEntry> Queue;             // also the pairs still waiting for their start
+    std::vector<uint32> AverageWaits;       // skirmish and rated average wait of every bracket
+
+    // Writes to a temporary file first and renames it over the old snapshot
+    bool Write(std::string const& path, std::string& error) const;
+    bool Read(std::string const& path, std::string& error);
+};
+
+#endif
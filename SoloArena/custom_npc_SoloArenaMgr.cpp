@@ -1,13 +1,20 @@
 // This code is licensed under MIT license
 
 #include "SimpleGossip.h"
+#include "SimpleGossipRegistry.h"
 #include "SoloArenaMgr.h"
+#include "Chat.h"
+#include "ChatCommand.h"
 #include "Common.h"
 #include "Player.h"
 #include "CreatureAI.h"
+#include "DBCStores.h"
 #include "Log.h"
+#include "RBAC.h"
 #include "ScriptMgr.h"
 
+using namespace Trinity::ChatCommands;
+
 class custom_npc_SoloArena : public CreatureScript
 {
 public:
@@ -37,9 +44,10 @@ public:
                 return false;
             }
 
+            uint32 const sender = player->PlayerTalkClass->GetGossipOptionSender(gossipListId);
             uint32 const action = player->PlayerTalkClass->GetGossipOptionAction(gossipListId);
 
-            sSoloArenaMgr->Gossip->SelectGossipOption(player, action);
+            sSoloArenaMgr->Gossip->SelectGossipOption(player, sender, action);
 
             return true;
         }
@@ -79,10 +87,274 @@ public:
             TC_LOG_INFO("server.loading", "Loaded custom_npc_SoloArena script...");
         }
     }
+
+    // The arena teams are loaded after the config, so the ladder waits for the world to be up
+    void OnStartup() override
+    {
+        sSoloArenaMgr->LoadSnapshot();
+    }
+
+    void OnUpdate(uint32 diff) override
+    {
+        sSoloArenaMgr->Update(diff);
+    }
+
+    void OnShutdown() override
+    {
+        sSoloArenaMgr->Shutdown();
+    }
+};
+
+class custom_npc_SoloArena_player : public PlayerScript
+{
+public:
+    custom_npc_SoloArena_player() : PlayerScript("custom_npc_SoloArena_player") { }
+
+    void OnLogin(Player* player, bool /*firstLogin*/) override
+    {
+        sSoloArenaMgr->OnPlayerLogin(player);
+    }
+};
+
+class custom_cs_soloarena : public CommandScript
+{
+public:
+    custom_cs_soloarena() : CommandScript("custom_cs_soloarena") { }
+
+    ChatCommandTable GetCommands() const override
+    {
+        static ChatCommandTable soloArenaSeasonCommandTable =
+        {
+            { "preview",  HandleSoloArenaSeasonPreviewCommand,  rbac::RBAC_PERM_COMMAND_ARENA_INFO,     Console::Yes },
+            { "rollover", HandleSoloArenaSeasonRolloverCommand, rbac::RBAC_PERM_COMMAND_ARENA_DISSOLVE, Console::Yes },
+        };
+        static ChatCommandTable soloArenaCommandTable =
+        {
+            { "season",      soloArenaSeasonCommandTable },
+            { "live",        HandleSoloArenaLiveCommand,        rbac::RBAC_PERM_COMMAND_ARENA_INFO, Console::Yes },
+            { "spectate",    HandleSoloArenaSpectateCommand,    rbac::RBAC_PERM_COMMAND_APPEAR,     Console::No },
+            { "matchups",    HandleSoloArenaMatchupsCommand,    rbac::RBAC_PERM_COMMAND_ARENA_INFO, Console::Yes },
+            { "matchmaking", HandleSoloArenaMatchmakingCommand, rbac::RBAC_PERM_COMMAND_ARENA_INFO, Console::Yes },
+        };
+        static ChatCommandTable commandTable =
+        {
+            { "soloarena", soloArenaCommandTable },
+        };
+        return commandTable;
+    }
+
+    static bool HandleSoloArenaSeasonPreviewCommand(ChatHandler* handler)
+    {
+        return HandleSoloArenaSeason(handler, false);
+    }
+
+    static bool HandleSoloArenaSeasonRolloverCommand(ChatHandler* handler)
+    {
+        return HandleSoloArenaSeason(handler, true);
+    }
+
+    static bool HandleSoloArenaSeason(ChatHandler* handler, bool apply)
+    {
+        SoloArenaSeasonReport report;
+        sSoloArenaMgr->RunSeasonRollover(apply, report);
+
+        handler->PSendSysMessage("Solo Arena season %s: %u teams, %u decayed, %u compressed.", apply ? "rollover" : "preview", report.Teams, report.Decayed, report.Compressed);
+        for (size_t i = 0; i < report.Cutoffs.size(); ++i)
+        {
+            size_t tier = report.Cutoffs.size() - i;
+            handler->PSendSysMessage("  Reward tier %u: top %u per mille, rating %u or more, %u teams.",
+                uint32(tier), sSoloArenaMgr->SeasonRewardCutoffs[i], report.Cutoffs[i], report.TierCounts[tier]);
+        }
+        if (apply)
+        {
+            handler->PSendSysMessage("  %u teams written in %u transactions.", report.Written, report.Transactions);
+        }
+        handler->PSendSysMessage("  Timings (us): load " UI64FMTD ", decay " UI64FMTD ", cutoffs " UI64FMTD ", tiers " UI64FMTD ", compress " UI64FMTD ", write " UI64FMTD ".",
+            report.LoadMicros, report.DecayMicros, report.CutoffMicros, report.TierMicros, report.CompressMicros, report.WriteMicros);
+        return true;
+    }
+
+    static bool HandleSoloArenaLiveCommand(ChatHandler* handler, Optional<uint32> count)
+    {
+        handler->PSendSysMessage("Solo Arena live matches: %u.", uint32(sSoloArenaMgr->GetLiveMatchCount()));
+
+        uint32 place = 0;
+        sSoloArenaMgr->ForEachTopLiveMatch(count.value_or(sSoloArenaMgr->LiveMatchesShown), [&](ActiveSoloMatch const& match)
+        {
+            handler->PSendSysMessage("  %u. [%u] %s", ++place, match.InstanceId, sSoloArenaMgr->DescribeLiveMatch(match).c_str());
+        });
+        return true;
+    }
+
+    // Without an instance id the highest rated live match is watched
+    static bool HandleSoloArenaSpectateCommand(ChatHandler* handler, Optional<uint32> instanceId)
+    {
+        Player* player = handler->GetSession()->GetPlayer();
+        if (!player->IsGameMaster())
+        {
+            handler->SendSysMessage("Turn GM mode on to spectate Solo Arena matches.");
+            handler->SetSentErrorMessage(true);
+            return false;
+        }
+
+        ActiveSoloMatch const* match = instanceId ? sSoloArenaMgr->GetLiveMatch(*instanceId) : sSoloArenaMgr->GetLiveMatchByPlace(0);
+        if (!match || !sSoloArenaMgr->SpectateLiveMatch(player, match->InstanceId))
+        {
+            handler->SendSysMessage("There is no such live Solo Arena match.");
+            handler->SetSentErrorMessage(true);
+            return false;
+        }
+
+        handler->PSendSysMessage("Spectating %s.", sSoloArenaMgr->DescribeLiveMatch(*match).c_str());
+        return true;
+    }
+
+    // Talent tab ids as used by Arena.1v1.ForbiddenTalentTrees, by matchup tab
+    static uint32 GetTalentTabId(uint8 matchupTab)
+    {
+        for (uint32 i = 0; i < sTalentTabStore.GetNumRows(); ++i)
+        {
+            TalentTabEntry const* tab = sTalentTabStore.LookupEntry(i);
+            if (!tab || !tab->ClassMask || tab->PetTalentMask)
+            {
+                continue;
+            }
+
+            uint8 classId = 1;
+            while (classId < 32 && !(tab->ClassMask & (1 << (classId - 1))))
+            {
+                ++classId;
+            }
+            if (SoloArenaMatchups::GetTab(classId, tab->OrderIndex) == matchupTab)
+            {
+                return tab->ID;
+            }
+        }
+        return 0;
+    }
+
+    static std::string GetMatchupTabName(uint8 matchupTab)
+    {
+        static char const* const names[SOLO_ARENA_MATCHUP_TABS] =
+        {
+            "Arms Warrior", "Fury Warrior", "Protection Warrior",
+            "Holy Paladin", "Protection Paladin", "Retribution Paladin",
+            "Beast Mastery Hunter", "Marksmanship Hunter", "Survival Hunter",
+            "Assassination Rogue", "Combat Rogue", "Subtlety Rogue",
+            "Discipline Priest", "Holy Priest", "Shadow Priest",
+            "Blood Death Knight", "Frost Death Knight", "Unholy Death Knight",
+            "Elemental Shaman", "Enhancement Shaman", "Restoration Shaman",
+            "Arcane Mage", "Fire Mage", "Frost Mage",
+            "Affliction Warlock", "Demonology Warlock", "Destruction Warlock",
+            nullptr, nullptr, nullptr,
+            "Balance Druid", "Feral Druid", "Restoration Druid",
+            "No talents"
+        };
+
+        if (matchupTab >= SOLO_ARENA_MATCHUP_TABS || !names[matchupTab])
+        {
+            return "Unknown";
+        }
+        if (uint32 tabId = GetTalentTabId(matchupTab))
+        {
+            return std::string(names[matchupTab]) + " (" + std::to_string(tabId) + ")";
+        }
+        return names[matchupTab];
+    }
+
+    // Matchmaking passes per bracket since startup, how many of them the time budget split and into how many slices.
+    static bool HandleSoloArenaMatchmakingCommand(ChatHandler* handler)
+    {
+        handler->PSendSysMessage("Solo Arena matchmaking, budget %u us per update (0 unlimited):", sSoloArenaMgr->MatchmakingBudget);
+
+        SoloArenaMatchmakingStats total;
+        for (uint32 bracket = BG_BRACKET_ID_FIRST; bracket < MAX_BATTLEGROUND_BRACKETS; ++bracket)
+        {
+            SoloArenaMatchmakingStats const& stats = sSoloArenaMgr->GetMatchmakingStats(bracket);
+            total.Add(stats);
+            if (!stats.Passes)
+            {
+                continue;
+            }
+
+            handler->PSendSysMessage("  Bracket %u: " UI64FMTD " passes, " UI64FMTD " split, " UI64FMTD " slices, longest %u slices, " UI64FMTD " us.",
+                bracket, stats.Passes, stats.SplitPasses, stats.Slices, stats.MaxSlices, stats.Micros);
+        }
+
+        handler->PSendSysMessage("  Total: " UI64FMTD " passes, " UI64FMTD " split, " UI64FMTD " slices, longest %u slices, " UI64FMTD " us.",
+            total.Passes, total.SplitPasses, total.Slices, total.MaxSlices, total.Micros);
+        return true;
+    }
+
+    // Every pair of tabs that met in rated 1v1, with the wins of each side. Without a band all bands are added up.
+    static bool HandleSoloArenaMatchupsCommand(ChatHandler* handler, Optional<uint8> band)
+    {
+        if (band && *band >= SOLO_ARENA_MATCHUP_BANDS)
+        {
+            handler->PSendSysMessage("Rating bands go from 0 to %u.", uint32(SOLO_ARENA_MATCHUP_BANDS - 1));
+            handler->SetSentErrorMessage(true);
+            return false;
+        }
+
+        SoloArenaMatchups const& matchups = sSoloArenaMgr->GetMatchups();
+        auto wins = [&](uint8 winner, uint8 loser) { return band ? matchups.GetWins(*band, winner, loser) : matchups.GetWinsInAllBands(winner, loser); };
+
+        if (band)
+        {
+            uint32 low = *band ? SOLO_ARENA_MATCHUP_BAND_START + (*band - 1) * SOLO_ARENA_MATCHUP_BAND_WIDTH : 0;
+            uint32 high = SOLO_ARENA_MATCHUP_BAND_START + *band * SOLO_ARENA_MATCHUP_BAND_WIDTH;
+            if (*band == SOLO_ARENA_MATCHUP_BANDS - 1)
+            {
+                handler->PSendSysMessage("Solo Arena rated matchups, average rating %u and above:", low);
+            }
+            else
+            {
+                handler->PSendSysMessage("Solo Arena rated matchups, average rating %u to %u:", low, high - 1);
+            }
+        }
+        else
+        {
+            handler->SendSysMessage("Solo Arena rated matchups, all ratings:");
+        }
+
+        uint32 shown = 0;
+        for (uint8 a = 0; a < SOLO_ARENA_MATCHUP_TABS; ++a)
+        {
+            for (uint8 b = a; b < SOLO_ARENA_MATCHUP_TABS; ++b)
+            {
+                uint32 aWins = wins(a, b);
+                uint32 bWins = a == b ? 0 : wins(b, a);
+                if (!aWins && !bWins)
+                {
+                    continue;
+                }
+
+                ++shown;
+                if (a == b)
+                {
+                    handler->PSendSysMessage("  %s mirror: %u games", GetMatchupTabName(a).c_str(), aWins);
+                    continue;
+                }
+
+                handler->PSendSysMessage("  %s vs %s: %u - %u (%u%%)", GetMatchupTabName(a).c_str(), GetMatchupTabName(b).c_str(),
+                    aWins, bWins, aWins * 100 / (aWins + bWins));
+            }
+        }
+
+        if (!shown)
+        {
+            handler->SendSysMessage("  No rated matches recorded yet.");
+        }
+        return true;
+    }
 };
 
 void Add_Custom_NPC_SoloArena()
 {
     new custom_npc_SoloArena();
     new custom_npc_SoloArena_world();
+    new custom_npc_SoloArena_player();
+    new custom_cs_soloarena();
+    AddSC_SimpleGossipState();
+    AddSC_SimpleGossipRegistry();
 }
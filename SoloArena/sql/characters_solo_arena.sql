@@ -0,0 +1,21 @@
+-- Solo Arena tables for the characters database
+
+CREATE TABLE IF NOT EXISTS `character_solo_arena_history` (
+  `guid` INT UNSIGNED NOT NULL,
+  `slot` TINYINT UNSIGNED NOT NULL COMMENT 'Ring slot, 0 to SOLO_ARENA_HISTORY_SIZE - 1',
+  `opponent` INT UNSIGNED NOT NULL DEFAULT 0,
+  `ratingChange` SMALLINT NOT NULL DEFAULT 0,
+  `won` TINYINT UNSIGNED NOT NULL DEFAULT 0,
+  `rated` TINYINT UNSIGNED NOT NULL DEFAULT 0,
+  `duration` INT UNSIGNED NOT NULL DEFAULT 0 COMMENT 'Seconds',
+  `endTime` INT UNSIGNED NOT NULL DEFAULT 0 COMMENT 'Unix time',
+  PRIMARY KEY (`guid`, `slot`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci;
+
+CREATE TABLE IF NOT EXISTS `solo_arena_matchups` (
+  `band` TINYINT UNSIGNED NOT NULL COMMENT 'Average matchmaker rating band, see SOLO_ARENA_MATCHUP_BANDS',
+  `winnerTab` TINYINT UNSIGNED NOT NULL COMMENT '(class - 1) * 3 + talent tab page, 33 for no talents',
+  `loserTab` TINYINT UNSIGNED NOT NULL,
+  `wins` INT UNSIGNED NOT NULL DEFAULT 0,
+  PRIMARY KEY (`band`, `winnerTab`, `loserTab`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci;